@@ -0,0 +1,724 @@
+/******************************************************************************
+* openflap
+* Copyright (C) 2014  Alan Witkowski
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*******************************************************************************/
+#include "common.h"
+#include <game.h>
+#include <batch.h>
+#include <serve.h>
+#include <raster.h>
+#include <population.h>
+#include <policy.h>
+#include <render.h>
+#include <assets.h>
+#include <capture.h>
+#include <pacer.h>
+#include <sprite.h>
+#include <physics.h>
+#include <textbuffer.h>
+#include <constants.h>
+#include <SDL.h>
+#include <SDL_ttf.h>
+#include <SDL_image.h>
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <algorithm>
+#include <vector>
+#include <string>
+#include <list>
+#include <cmath>
+#include <cstdlib>
+#include <thread>
+// Wall as it was stored before _SpriteBuffer
+struct _ListWall {
+	_Physics Physics;
+	int Width, Height;
+};
+
+typedef std::list<_ListWall *>::iterator ListWallIteratorType;
+
+// Timing of one microbenchmark
+struct _BenchResult {
+	std::string Name;
+	uint64_t Operations;
+	double NanosecondsPerOperation;
+	double AllocationsPerOperation;
+	double Percentiles[3];
+};
+
+const int BENCH_WIDTH = DEFAULT_SCREEN_WIDTH;
+const int BENCH_HEIGHT = DEFAULT_SCREEN_HEIGHT;
+const int BENCH_TICKS = 200000;
+const int BENCH_PHYSICS_TICKS = 10000000;
+const int BENCH_FORMAT_COUNT = 1000000;
+const int BENCH_SNAPSHOT_COUNT = 1000000;
+const int BENCH_SAMPLES = 200;
+const int BENCH_RENDER_SAMPLES = 100;
+const int BENCH_SWEPT_SEEDS = 2000;
+const int BENCH_SWEPT_TICKS_PER_STEP = 5;
+const int BENCH_BATCH_LANES = 1024;
+const int BENCH_BATCH_STEPS = 2000;
+const int BENCH_SERVE_LATENCY_STEPS = 10000;
+const int BENCH_SERVE_THROUGHPUT_STEPS = 1000;
+const int BENCH_POPULATION_MARGINS = 256;
+const int BENCH_POPULATION_PLAYERS = 4096;
+const int BENCH_POPULATION_STEPS = 2000;
+const int BENCH_RASTER_SIZE = 84;
+const int BENCH_PACER_FRAMES = 600;
+const double BENCH_PACER_WORK = 0.001;
+const double BENCH_PERCENTILES[3] = { 50.0, 90.0, 99.0 };
+
+// Keeps benchmarked results from being optimized away
+static volatile int BenchSink = 0;
+
+// Test circle against box
+static inline bool TestCircle(float Left, float Top, float Right, float Bottom, float CircleX, float CircleY, float Radius) {
+	float X = CircleX < Left ? Left : (CircleX > Right ? Right : CircleX);
+	float Y = CircleY < Top ? Top : (CircleY > Bottom ? Bottom : CircleY);
+	float DistanceX = X - CircleX;
+	float DistanceY = Y - CircleY;
+
+	return DistanceX * DistanceX + DistanceY * DistanceY < Radius * Radius;
+}
+
+// Get number of ticks between spawns that keeps the given number of walls alive
+static int GetSpawnInterval(int WallCount) {
+	float Lifetime = (BENCH_WIDTH + WALL_WIDTH) / -WALL_VELOCITY / GAME_TIMESTEP;
+	int Interval = (int)(Lifetime * 2.0f / WallCount);
+
+	return Interval < 1 ? 1 : Interval;
+}
+
+// Update, cull, spawn and collide walls kept in a list of heap objects
+static double RunList(int WallCount, int &Hits) {
+	std::list<_ListWall *> Walls;
+	int SpawnInterval = GetSpawnInterval(WallCount);
+
+	std::chrono::steady_clock::time_point StartTime = std::chrono::steady_clock::now();
+	for(int Tick = 0; Tick < BENCH_TICKS; Tick++) {
+		for(ListWallIteratorType Iterator = Walls.begin(); Iterator != Walls.end(); ) {
+			_ListWall *Wall = *Iterator;
+			Wall->Physics.Update(GAME_TIMESTEP);
+			if(Wall->Physics.GetPosition().X + Wall->Width < 0) {
+				delete Wall;
+				Iterator = Walls.erase(Iterator);
+			}
+			else
+				++Iterator;
+		}
+
+		if(Tick % SpawnInterval == 0) {
+			float MidY = BENCH_HEIGHT / 2 + (Tick % 7 - 3) * 40.0f;
+			_ListWall *Top = new _ListWall();
+			Top->Physics = _Physics(Vector2(BENCH_WIDTH, 0), Vector2(WALL_VELOCITY, 0), Vector2(0, 0));
+			Top->Width = (int)WALL_WIDTH;
+			Top->Height = (int)(MidY - SPACING);
+			Walls.push_back(Top);
+
+			_ListWall *Bottom = new _ListWall();
+			Bottom->Physics = _Physics(Vector2(BENCH_WIDTH, MidY + SPACING), Vector2(WALL_VELOCITY, 0), Vector2(0, 0));
+			Bottom->Width = (int)WALL_WIDTH;
+			Bottom->Height = (int)(BENCH_HEIGHT - (MidY + SPACING));
+			Walls.push_back(Bottom);
+		}
+
+		for(ListWallIteratorType Iterator = Walls.begin(); Iterator != Walls.end(); ++Iterator) {
+			const _ListWall *Wall = *Iterator;
+			const Vector2 &Position = Wall->Physics.GetPosition();
+			Hits += TestCircle(Position.X, Position.Y, Position.X + Wall->Width, Position.Y + Wall->Height, 100.0f, BENCH_HEIGHT / 2, PLAYER_RADIUS);
+		}
+	}
+	double Elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - StartTime).count();
+
+	for(ListWallIteratorType Iterator = Walls.begin(); Iterator != Walls.end(); ++Iterator)
+		delete *Iterator;
+
+	return BENCH_TICKS / Elapsed;
+}
+
+// Update, cull, spawn and collide walls kept in a ring buffer of arrays
+static double RunBuffer(int WallCount, int &Hits) {
+	_SpriteBuffer Walls;
+	int SpawnInterval = GetSpawnInterval(WallCount);
+
+	std::chrono::steady_clock::time_point StartTime = std::chrono::steady_clock::now();
+	for(int Tick = 0; Tick < BENCH_TICKS; Tick++) {
+		Walls.Update(GAME_TIMESTEP);
+		while(Walls.GetCount() && Walls.X[Walls.GetIndex(0)] + Walls.Width[Walls.GetIndex(0)] < 0)
+			Walls.RemoveFront();
+
+		if(Tick % SpawnInterval == 0) {
+			float MidY = BENCH_HEIGHT / 2 + (Tick % 7 - 3) * 40.0f;
+			Walls.Add(BENCH_WIDTH, 0, (int)WALL_WIDTH, (int)(MidY - SPACING), WALL_VELOCITY, 0);
+			Walls.Add(BENCH_WIDTH, MidY + SPACING, (int)WALL_WIDTH, (int)(BENCH_HEIGHT - (MidY + SPACING)), WALL_VELOCITY, 0);
+		}
+
+		for(int i = 0; i < Walls.GetCount(); i++) {
+			int Index = Walls.GetIndex(i);
+			Hits += TestCircle(Walls.X[Index], Walls.Y[Index], Walls.X[Index] + Walls.Width[Index], Walls.Y[Index] + Walls.Height[Index], 100.0f, BENCH_HEIGHT / 2, PLAYER_RADIUS);
+		}
+	}
+	double Elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - StartTime).count();
+
+	return BENCH_TICKS / Elapsed;
+}
+
+// Compare wall storage at increasing densities
+static void RunWallBenchmarks() {
+	const int Densities[] = { 6, 16, 32, 60 };
+	std::cout << std::fixed << std::setprecision(0);
+	for(int WallCount : Densities) {
+		int ListHits = 0, BufferHits = 0;
+		double ListRate = RunList(WallCount, ListHits);
+		double BufferRate = RunBuffer(WallCount, BufferHits);
+
+		std::cout << "walls=" << WallCount << " list_ticks/sec=" << ListRate << " buffer_ticks/sec=" << BufferRate;
+		std::cout << " speedup=" << std::setprecision(2) << BufferRate / ListRate << std::setprecision(0);
+		if(ListHits != BufferHits)
+			std::cout << " hit mismatch " << ListHits << " != " << BufferHits;
+		std::cout << std::endl;
+	}
+}
+
+// Measure cost of one player update per integrator
+static void RunIntegratorBenchmarks() {
+	const IntegratorType Integrators[] = { INTEGRATOR_RK4, INTEGRATOR_ANALYTIC, INTEGRATOR_EULER };
+	const char *Names[] = { "rk4", "analytic", "euler" };
+
+	for(int i = 0; i < 3; i++) {
+		_Physics Physics(Vector2(100.0f, 300.0f), Vector2(0.0f, 0.0f), Vector2(0.0f, GRAVITY));
+		Physics.SetIntegrator(Integrators[i]);
+
+		// Jump every 84 ticks, a full arc, to stay in a realistic range
+		float Sum = 0.0f;
+		std::chrono::steady_clock::time_point StartTime = std::chrono::steady_clock::now();
+		for(int Tick = 0; Tick < BENCH_PHYSICS_TICKS; Tick++) {
+			if(Tick % 84 == 0)
+				Physics.SetVelocity(Vector2(0.0f, JUMP_POWER));
+			Physics.Update(GAME_TIMESTEP);
+			Sum += Physics.GetPosition().Y;
+		}
+		double Elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - StartTime).count();
+
+		std::cout << "integrator=" << Names[i] << std::setprecision(2) << " ns/tick=" << Elapsed * 1e9 / BENCH_PHYSICS_TICKS;
+		std::cout << std::setprecision(0) << " checksum=" << Sum << std::endl;
+	}
+}
+
+// Measure HUD line formatting
+static void RunFormatBenchmarks() {
+	float Time = 0.0f;
+	uint32_t Length = 0;
+	uint64_t Allocations = AllocationCount;
+	std::chrono::steady_clock::time_point StartTime = std::chrono::steady_clock::now();
+	for(int i = 0; i < BENCH_FORMAT_COUNT; i++) {
+		_TextBuffer Buffer;
+		Buffer.Append("Time: ").Append(Time, 2);
+		Length += Buffer.GetLength();
+
+		Buffer.Clear();
+		Buffer.Append("Seed: ").Append((uint32_t)i);
+		Length += Buffer.GetLength();
+		Time += GAME_TIMESTEP;
+	}
+	double Elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - StartTime).count();
+	Allocations = AllocationCount - Allocations;
+
+	std::cout << "format" << std::setprecision(2) << " ns/op=" << Elapsed * 1e9 / BENCH_FORMAT_COUNT;
+	std::cout << " allocations=" << Allocations << " checksum=" << Length << std::endl;
+}
+
+// Measure snapshot cost
+static void RunSnapshotBenchmarks() {
+	_Game Game(DEFAULT_SCREEN_WIDTH, DEFAULT_SCREEN_HEIGHT);
+	_FollowPolicy Policy;
+	Game.Init(0);
+	Advance(Game, Policy, 500);
+
+	// Time save and restore pairs
+	_GameState Snapshot;
+	std::chrono::steady_clock::time_point StartTime = std::chrono::steady_clock::now();
+	for(int i = 0; i < BENCH_SNAPSHOT_COUNT; i++) {
+		Game.Save(Snapshot);
+		Game.Restore(Snapshot);
+	}
+	double Elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - StartTime).count();
+
+	std::cout << "snapshot bytes=" << sizeof(_GameState) << std::setprecision(2) << " save_restore_ns=" << Elapsed * 1e9 / BENCH_SNAPSHOT_COUNT << std::endl;
+}
+
+// Compare coarse steps with single ticks playing the same jumps
+static void RunSweptBenchmarks() {
+
+	// Record each game's jumps at the coarse rate and play them back in a game stepping one tick at a time
+	_Game Coarse(DEFAULT_SCREEN_WIDTH, DEFAULT_SCREEN_HEIGHT);
+	_Game Fine(DEFAULT_SCREEN_WIDTH, DEFAULT_SCREEN_HEIGHT);
+	Coarse.TicksPerStep = BENCH_SWEPT_TICKS_PER_STEP;
+	_FollowPolicy Policy;
+	uint64_t Ticks = 0;
+	double CoarseTime = 0.0, FineTime = 0.0;
+	for(uint32_t Seed = 0; Seed < BENCH_SWEPT_SEEDS; Seed++) {
+		std::chrono::steady_clock::time_point StartTime = std::chrono::steady_clock::now();
+		std::vector<uint32_t> Jumps = PlayRecorded(Coarse, Policy, Seed);
+		std::chrono::steady_clock::time_point CoarseEnd = std::chrono::steady_clock::now();
+
+		Fine.Init(Seed);
+		size_t Jump = 0;
+		while(Fine.State == STATE_PLAY) {
+			_Input Input;
+			Input.Jump = Jump < Jumps.size() && Jumps[Jump] == Fine.Ticks;
+			if(Input.Jump)
+				Jump++;
+			Fine.Step(Input);
+		}
+		FineTime += std::chrono::duration<double>(std::chrono::steady_clock::now() - CoarseEnd).count();
+		CoarseTime += std::chrono::duration<double>(CoarseEnd - StartTime).count();
+
+		Ticks += Fine.Ticks;
+	}
+
+	std::cout << "swept ticks_per_step=" << BENCH_SWEPT_TICKS_PER_STEP << " seeds=" << BENCH_SWEPT_SEEDS << std::setprecision(2);
+	std::cout << " coarse_ns/tick=" << CoarseTime * 1e9 / Ticks << " fine_ns/tick=" << FineTime * 1e9 / Ticks;
+	std::cout << " speedup=" << FineTime / CoarseTime << std::endl;
+}
+
+// Compare lane steps per second with stepping games one by one
+static void RunBatchBenchmarks() {
+
+	// Step with a fixed jump pattern, so lanes die and reset along the way
+	std::vector<uint8_t> Pattern(BENCH_BATCH_LANES * 24);
+	for(size_t i = 0; i < Pattern.size(); i++)
+		Pattern[i] = (i * 2654435761u >> 16) % 24 == 0;
+
+	_Batch Lanes(BENCH_BATCH_LANES, DEFAULT_SCREEN_WIDTH, DEFAULT_SCREEN_HEIGHT);
+	Lanes.Init(0);
+	int Ended = 0;
+	std::chrono::steady_clock::time_point StartTime = std::chrono::steady_clock::now();
+	for(int Step = 0; Step < BENCH_BATCH_STEPS; Step++)
+		Ended += Lanes.Step(&Pattern[(Step % 24) * BENCH_BATCH_LANES]);
+	double BatchTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - StartTime).count();
+
+	std::vector<_Game> Games(BENCH_BATCH_LANES, _Game(DEFAULT_SCREEN_WIDTH, DEFAULT_SCREEN_HEIGHT));
+	for(int Lane = 0; Lane < BENCH_BATCH_LANES; Lane++)
+		Games[Lane].Init(Lane);
+	int GamesEnded = 0;
+	StartTime = std::chrono::steady_clock::now();
+	for(int Step = 0; Step < BENCH_BATCH_STEPS; Step++) {
+		const uint8_t *StepJumps = &Pattern[(Step % 24) * BENCH_BATCH_LANES];
+		for(int Lane = 0; Lane < BENCH_BATCH_LANES; Lane++) {
+			_Input Input;
+			Input.Jump = StepJumps[Lane];
+			if(Games[Lane].Step(Input) & EVENT_DIED) {
+				Games[Lane].Init(Games[Lane].Seed + BENCH_BATCH_LANES);
+				GamesEnded++;
+			}
+		}
+	}
+	double GameTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - StartTime).count();
+
+	double LaneSteps = (double)BENCH_BATCH_LANES * BENCH_BATCH_STEPS;
+	std::cout << "batch lanes=" << BENCH_BATCH_LANES << " ended=" << Ended << "," << GamesEnded;
+	std::cout << std::setprecision(0) << " steps/sec=" << LaneSteps / BatchTime << " game_steps/sec=" << LaneSteps / GameTime;
+	std::cout << std::setprecision(2) << " speedup=" << GameTime / BatchTime << std::endl;
+}
+
+// Compare player steps per second with batch lanes deciding the same way
+static void RunPopulationBenchmarks() {
+
+	// Give players a spread of margins, as a population training them would
+	std::vector<float> Margins(BENCH_POPULATION_PLAYERS);
+	for(int i = 0; i < BENCH_POPULATION_PLAYERS; i++)
+		Margins[i] = POPULATION_MAX_MARGIN * (i % BENCH_POPULATION_MARGINS) / BENCH_POPULATION_MARGINS;
+
+	std::vector<uint8_t> Jumps(BENCH_POPULATION_PLAYERS);
+
+	// Fly a large population until everyone dies, counting the steps of living players
+	_Population Population(BENCH_POPULATION_PLAYERS, DEFAULT_SCREEN_WIDTH, DEFAULT_SCREEN_HEIGHT);
+	double PlayerSteps = 0.0;
+	uint32_t Seed = 0;
+	std::chrono::steady_clock::time_point StartTime = std::chrono::steady_clock::now();
+	for(int Step = 0; Step < BENCH_POPULATION_STEPS; Step++) {
+		if(!Population.GetAlive())
+			Population.Init(Seed++);
+
+		PlayerSteps += Population.GetAlive();
+		Population.GetFollowJumps(Margins.data(), Jumps.data());
+		Population.Step(Jumps.data());
+	}
+	double PopulationTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - StartTime).count();
+
+	// Batch lanes each carry their own walls and find their own gap
+	_Batch Batch(BENCH_POPULATION_PLAYERS, DEFAULT_SCREEN_WIDTH, DEFAULT_SCREEN_HEIGHT);
+	Batch.Init(0);
+	StartTime = std::chrono::steady_clock::now();
+	for(int Step = 0; Step < BENCH_POPULATION_STEPS; Step++) {
+		for(int Lane = 0; Lane < BENCH_POPULATION_PLAYERS; Lane++)
+			Jumps[Lane] = GetBatchFollowJump(Batch, Lane);
+		Batch.Step(Jumps.data());
+	}
+	double BatchTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - StartTime).count();
+	double LaneSteps = (double)BENCH_POPULATION_PLAYERS * BENCH_POPULATION_STEPS;
+
+	std::cout << "population players=" << BENCH_POPULATION_PLAYERS;
+	std::cout << " seeds=" << Seed << std::setprecision(0) << " player_steps/sec=" << PlayerSteps / PopulationTime << " batch_steps/sec=" << LaneSteps / BatchTime;
+	std::cout << std::setprecision(2) << " speedup=" << (PlayerSteps / PopulationTime) / (LaneSteps / BatchTime) << std::endl;
+}
+
+// Time round trips through a server thread
+static bool RunServeBenchmarks() {
+	std::string Name = "/openflap_bench_" + std::to_string(std::chrono::steady_clock::now().time_since_epoch().count());
+
+	// Measure round trips with one game and with many
+	const int EnvCounts[2] = { 1, SERVE_DEFAULT_ENVS };
+	const int StepCounts[2] = { BENCH_SERVE_LATENCY_STEPS, BENCH_SERVE_THROUGHPUT_STEPS };
+	bool Called = true;
+	for(int Run = 0; Run < 2; Run++) {
+		std::thread Server;
+		_ServeChannel Channel;
+		if(!StartServer(Name, EnvCounts[Run], Server, Channel)) {
+			std::cout << "serve unavailable" << std::endl;
+			if(Server.joinable())
+				Server.join();
+			return false;
+		}
+
+		std::vector<double> RoundTrips;
+		std::chrono::steady_clock::time_point StartTime = std::chrono::steady_clock::now();
+		for(int Step = 0; Step < StepCounts[Run]; Step++) {
+			std::chrono::steady_clock::time_point CallTime = std::chrono::steady_clock::now();
+			Called &= Channel.Call(SERVE_STEP);
+			RoundTrips.push_back(std::chrono::duration<double>(std::chrono::steady_clock::now() - CallTime).count());
+		}
+		double Elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - StartTime).count();
+		Channel.Call(SERVE_QUIT);
+		Channel.Close();
+		Server.join();
+
+		std::sort(RoundTrips.begin(), RoundTrips.end());
+		std::cout << "serve envs=" << EnvCounts[Run] << std::setprecision(1);
+		std::cout << " round_trip_p50_us=" << RoundTrips[RoundTrips.size() / 2] * 1e6 << " round_trip_p99_us=" << RoundTrips[RoundTrips.size() * 99 / 100] * 1e6;
+		std::cout << std::setprecision(0) << " env_steps/sec=" << (double)EnvCounts[Run] * StepCounts[Run] / Elapsed;
+		std::cout << (Called ? "" : " FAIL") << std::endl;
+	}
+
+	return Called;
+}
+
+// Busy wait to stand in for a frame's work
+static void SpinFor(double Seconds) {
+	std::chrono::steady_clock::time_point End = std::chrono::steady_clock::now() + std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(Seconds));
+	while(std::chrono::steady_clock::now() < End)
+		BenchSink++;
+}
+
+// Print the mean, standard deviation and worst error of frame intervals in milliseconds
+static void PrintIntervals(const char *Name, const std::vector<double> &Intervals, double Target) {
+	double Sum = 0.0, SumSquares = 0.0, MaxError = 0.0;
+	for(size_t i = 0; i < Intervals.size(); i++) {
+		Sum += Intervals[i];
+		SumSquares += Intervals[i] * Intervals[i];
+		MaxError = std::max(MaxError, std::abs(Intervals[i] - Target));
+	}
+	double Mean = Sum / Intervals.size();
+	double Jitter = std::sqrt(std::max(SumSquares / Intervals.size() - Mean * Mean, 0.0));
+
+	std::cout << "pacer=" << Name << std::setprecision(3) << " target_ms=" << Target * 1000.0 << " mean_ms=" << Mean * 1000.0;
+	std::cout << " jitter_ms=" << Jitter * 1000.0 << " max_error_ms=" << MaxError * 1000.0 << std::endl;
+}
+
+// Compare frame intervals of the old SDL_Delay limiter and the deadline pacer at the uncapped frame rate
+static void RunPacerBenchmarks() {
+	double Target = 1.0 / GAME_MAXFPS;
+	std::vector<double> Intervals;
+
+	// Delay for the remainder of the target after the previous frame's time, truncated to milliseconds
+	std::chrono::steady_clock::time_point Timer = std::chrono::steady_clock::now();
+	for(int i = 0; i <= BENCH_PACER_FRAMES; i++) {
+		std::chrono::steady_clock::time_point FrameStart = std::chrono::steady_clock::now();
+		double FrameTime = std::chrono::duration<double>(FrameStart - Timer).count();
+		Timer = FrameStart;
+		if(i)
+			Intervals.push_back(FrameTime);
+
+		SpinFor(BENCH_PACER_WORK);
+		double ExtraTime = Target - FrameTime;
+		if(ExtraTime > 0.0)
+			SDL_Delay((Uint32)(ExtraTime * 1000));
+	}
+	PrintIntervals("sdl_delay", Intervals, Target);
+
+	// Sleep and spin to absolute deadlines
+	for(int SpinTime = 0; SpinTime <= 2; SpinTime++) {
+		_Pacer Pacer;
+		Pacer.Start(Target, SpinTime / 1000.0);
+		Intervals.clear();
+		Timer = std::chrono::steady_clock::now();
+		for(int i = 0; i <= BENCH_PACER_FRAMES; i++) {
+			std::chrono::steady_clock::time_point FrameStart = std::chrono::steady_clock::now();
+			if(i)
+				Intervals.push_back(std::chrono::duration<double>(FrameStart - Timer).count());
+			Timer = FrameStart;
+
+			SpinFor(BENCH_PACER_WORK);
+			Pacer.Wait();
+		}
+		std::string Name = "deadline_spin" + std::to_string(SpinTime) + "ms";
+		PrintIntervals(Name.c_str(), Intervals, Target);
+	}
+}
+
+// Time batches of an operation and summarize the cost per operation
+template<typename OperationType> static _BenchResult Measure(const char *Name, int Samples, int BatchSize, OperationType Operation) {
+	std::vector<double> Times(Samples);
+
+	// Warm up caches and lazily created state
+	for(int i = 0; i < BatchSize; i++)
+		Operation();
+
+	double TotalTime = 0.0;
+	uint64_t Allocations = AllocationCount;
+	for(int Sample = 0; Sample < Samples; Sample++) {
+		std::chrono::steady_clock::time_point StartTime = std::chrono::steady_clock::now();
+		for(int i = 0; i < BatchSize; i++)
+			Operation();
+		double Elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - StartTime).count();
+
+		Times[Sample] = Elapsed * 1e9 / BatchSize;
+		TotalTime += Elapsed;
+	}
+	Allocations = AllocationCount - Allocations;
+
+	_BenchResult Result;
+	Result.Name = Name;
+	Result.Operations = (uint64_t)Samples * BatchSize;
+	Result.NanosecondsPerOperation = TotalTime * 1e9 / Result.Operations;
+	Result.AllocationsPerOperation = (double)Allocations / Result.Operations;
+
+	// Use nearest rank on the per batch averages
+	std::sort(Times.begin(), Times.end());
+	for(int i = 0; i < 3; i++) {
+		int Rank = (int)std::ceil(BENCH_PERCENTILES[i] / 100.0 * Samples) - 1;
+		Result.Percentiles[i] = Times[std::max(Rank, 0)];
+	}
+
+	return Result;
+}
+
+// Measure simulation hot paths
+static void RunSimulationBenchmarks(std::vector<_BenchResult> &Results) {
+
+	// Player integration
+	_Physics Physics(Vector2(100.0f, 300.0f), Vector2(0.0f, 0.0f), Vector2(0.0f, GRAVITY));
+	int PhysicsTick = 0;
+	Results.push_back(Measure("physics_update", BENCH_SAMPLES, 10000, [&]() {
+		if(PhysicsTick++ % 84 == 0)
+			Physics.SetVelocity(Vector2(0.0f, JUMP_POWER));
+		Physics.Update(GAME_TIMESTEP);
+	}));
+
+	// Collision against every wall on screen
+	_Game Game(DEFAULT_SCREEN_WIDTH, DEFAULT_SCREEN_HEIGHT);
+	_FollowPolicy Policy;
+	Game.Init(0);
+	Advance(Game, Policy, 1000);
+	int Cursor = 0, Hits = 0;
+	Results.push_back(Measure("check_wall_collision", BENCH_SAMPLES, 10000, [&]() {
+		Hits += Game.CheckWallCollision(Game.Walls.GetIndex(Cursor));
+		if(++Cursor == Game.Walls.GetCount())
+			Cursor = 0;
+	}));
+	BenchSink = Hits;
+
+	// Full tick with input, restarting after each death
+	uint32_t Seed = 0;
+	Results.push_back(Measure("step", BENCH_SAMPLES, 10000, [&]() {
+		if(Game.State != STATE_PLAY)
+			Game.Init(++Seed);
+
+		_Input Input;
+		Input.Jump = Policy.Jump(Game);
+		Game.Step(Input);
+	}));
+
+	// Converting a captured frame to YUV planes
+	std::vector<uint8_t> Pixels(DEFAULT_SCREEN_WIDTH * DEFAULT_SCREEN_HEIGHT * 4);
+	std::vector<uint8_t> Planes(DEFAULT_SCREEN_WIDTH * DEFAULT_SCREEN_HEIGHT * 3 / 2);
+	for(size_t i = 0; i < Pixels.size(); i++)
+		Pixels[i] = (uint8_t)(i * 2654435761u >> 24);
+	uint8_t *PlaneY = Planes.data();
+	uint8_t *PlaneU = PlaneY + DEFAULT_SCREEN_WIDTH * DEFAULT_SCREEN_HEIGHT;
+	uint8_t *PlaneV = PlaneU + DEFAULT_SCREEN_WIDTH * DEFAULT_SCREEN_HEIGHT / 4;
+	Results.push_back(Measure("capture_yuv", BENCH_RENDER_SAMPLES, 1, [&]() {
+		_Capture::ConvertToYUV(Pixels.data(), DEFAULT_SCREEN_WIDTH, DEFAULT_SCREEN_HEIGHT, PlaneY, PlaneU, PlaneV);
+	}));
+
+	// Small grayscale frames for pixel observations, one game and then a batch of them
+	_Raster Raster(BENCH_RASTER_SIZE, BENCH_RASTER_SIZE, DEFAULT_SCREEN_WIDTH, DEFAULT_SCREEN_HEIGHT);
+	std::vector<uint8_t> Frames((size_t)BENCH_BATCH_LANES * BENCH_RASTER_SIZE * BENCH_RASTER_SIZE);
+	Game.Init(0);
+	Advance(Game, Policy, 1000);
+	Results.push_back(Measure("raster_frame", BENCH_SAMPLES, 100, [&]() {
+		Raster.Draw(Game, Frames.data());
+	}));
+
+	_Batch Batch(BENCH_BATCH_LANES, DEFAULT_SCREEN_WIDTH, DEFAULT_SCREEN_HEIGHT);
+	std::vector<uint8_t> Jumps(BENCH_BATCH_LANES, 0);
+	Batch.Init(0);
+	for(int Step = 0; Step < 300; Step++) {
+		for(int i = 0; i < BENCH_BATCH_LANES; i++)
+			Jumps[i] = GetBatchFollowJump(Batch, i);
+		Batch.Step(Jumps.data());
+	}
+	Results.push_back(Measure("raster_batch", BENCH_RENDER_SAMPLES, 1, [&]() {
+		Raster.Draw(Batch, 0, BENCH_BATCH_LANES, Frames.data());
+	}));
+
+	// Spawning a wall pair, removing the oldest pair to keep the buffer from filling
+	Game.Init(0);
+	Game.SpawnWall(DEFAULT_SCREEN_HEIGHT / 2);
+	Results.push_back(Measure("spawn_wall", BENCH_SAMPLES, 10000, [&]() {
+		Game.SpawnWall(DEFAULT_SCREEN_HEIGHT / 2);
+		Game.Walls.RemoveFront();
+		Game.Walls.RemoveFront();
+	}));
+}
+
+// Measure a full frame with the software renderer and no window
+static bool RunRenderBenchmarks(std::vector<_BenchResult> &Results) {
+	SDL_SetHint(SDL_HINT_VIDEODRIVER, "dummy");
+	if(SDL_Init(SDL_INIT_VIDEO) != 0 || TTF_Init() != 0 || !(IMG_Init(IMG_INIT_PNG) & IMG_INIT_PNG)) {
+		std::cout << SDL_GetError() << std::endl;
+		return false;
+	}
+
+	SDL_Window *Window = SDL_CreateWindow("openflap_bench", 0, 0, DEFAULT_SCREEN_WIDTH, DEFAULT_SCREEN_HEIGHT, 0);
+	SDL_Renderer *Renderer = Window ? SDL_CreateRenderer(Window, -1, SDL_RENDERER_SOFTWARE) : nullptr;
+	if(!Renderer) {
+		std::cout << SDL_GetError() << std::endl;
+		SDL_Quit();
+		return false;
+	}
+
+	// Decode all images in parallel, from the pack when it has been built
+	Results.push_back(Measure("decode_images", BENCH_RENDER_SAMPLES / 10, 1, [&]() {
+		_Assets Assets;
+		Assets.Open(BENCH_DATA_PATH "openflap.pak", BENCH_DATA_PATH);
+		Assets.StartDecode();
+		Assets.FinishDecode();
+	}));
+
+	bool Passed = true;
+	{
+		_Assets Assets;
+		_Render Render;
+		Assets.Open(BENCH_DATA_PATH "openflap.pak", BENCH_DATA_PATH);
+		Assets.StartDecode();
+		if(Assets.FinishDecode() && Render.Load(Renderer, Assets)) {
+			Render.VersionText.Append("Version: ").Append(GAME_VERSION);
+			Render.SeedText.Append("Seed: ").Append((uint32_t)0);
+
+			// Draw a busy mid game frame
+			_Game Game(DEFAULT_SCREEN_WIDTH, DEFAULT_SCREEN_HEIGHT);
+			_FollowPolicy Policy;
+			Game.Init(0);
+			Advance(Game, Policy, 1000);
+			Results.push_back(Measure("render", BENCH_RENDER_SAMPLES, 1, [&]() {
+				Render.Draw(Game, 12.34f, 0.5f);
+				SDL_RenderPresent(Renderer);
+			}));
+		}
+		else {
+			std::cout << SDL_GetError() << std::endl;
+			Passed = false;
+		}
+	}
+
+	SDL_DestroyRenderer(Renderer);
+	SDL_DestroyWindow(Window);
+	IMG_Quit();
+	TTF_Quit();
+	SDL_Quit();
+
+	return Passed;
+}
+
+// Print microbenchmark results as one line each
+static void PrintResults(const std::vector<_BenchResult> &Results) {
+	for(size_t i = 0; i < Results.size(); i++) {
+		const _BenchResult &Result = Results[i];
+		std::cout << "bench=" << Result.Name << std::setprecision(2) << " ns/op=" << Result.NanosecondsPerOperation;
+		std::cout << " allocs/op=" << Result.AllocationsPerOperation;
+		for(int j = 0; j < 3; j++)
+			std::cout << " p" << (int)BENCH_PERCENTILES[j] << "=" << Result.Percentiles[j];
+		std::cout << std::endl;
+	}
+}
+
+// Print microbenchmark results as a JSON document
+static void PrintJSON(const std::vector<_BenchResult> &Results) {
+	std::cout << std::setprecision(3);
+	std::cout << "{\n";
+	std::cout << "\t\"version\": \"" << GAME_VERSION << "\",\n";
+	std::cout << "\t\"benchmarks\": [\n";
+	for(size_t i = 0; i < Results.size(); i++) {
+		const _BenchResult &Result = Results[i];
+		std::cout << "\t\t{ \"name\": \"" << Result.Name << "\", \"operations\": " << Result.Operations;
+		std::cout << ", \"ns_per_op\": " << Result.NanosecondsPerOperation << ", \"allocs_per_op\": " << Result.AllocationsPerOperation;
+		for(int j = 0; j < 3; j++)
+			std::cout << ", \"p" << (int)BENCH_PERCENTILES[j] << "_ns\": " << Result.Percentiles[j];
+		std::cout << " }" << (i + 1 < Results.size() ? "," : "") << "\n";
+	}
+	std::cout << "\t]\n";
+	std::cout << "}" << std::endl;
+}
+
+int main(int ArgumentCount, char **Arguments) {
+	bool JSON = ArgumentCount > 1 && std::string(Arguments[1]) == "--json";
+
+	// Keep stdout for the JSON document, sending errors and everything else to stderr
+	std::streambuf *Standard = std::cout.rdbuf();
+	if(JSON)
+		std::cout.rdbuf(std::cerr.rdbuf());
+
+	// Compare designs unless only tracking numbers
+	bool Passed = true;
+	if(!JSON) {
+		RunWallBenchmarks();
+		RunIntegratorBenchmarks();
+		RunFormatBenchmarks();
+		RunSnapshotBenchmarks();
+		RunSweptBenchmarks();
+		RunBatchBenchmarks();
+		RunPopulationBenchmarks();
+		Passed &= RunServeBenchmarks();
+		RunPacerBenchmarks();
+	}
+
+	// Run microbenchmarks
+	std::vector<_BenchResult> Results;
+	RunSimulationBenchmarks(Results);
+	Passed &= RunRenderBenchmarks(Results);
+	std::cout << std::fixed;
+	if(JSON) {
+		std::cout.rdbuf(Standard);
+		PrintJSON(Results);
+	}
+	else
+		PrintResults(Results);
+
+	return Passed ? 0 : 1;
+}
@@ -0,0 +1,107 @@
+/******************************************************************************
+* openflap
+* Copyright (C) 2014  Alan Witkowski
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*******************************************************************************/
+#include "common.h"
+#include <game.h>
+#include <batch.h>
+#include <policy.h>
+#include <serve.h>
+#include <constants.h>
+#include <chrono>
+#include <new>
+#include <cstdlib>
+
+uint64_t AllocationCount = 0;
+
+// Count allocations
+void *operator new(std::size_t Size) {
+	AllocationCount++;
+	void *Pointer = malloc(Size ? Size : 1);
+	if(!Pointer)
+		throw std::bad_alloc();
+
+	return Pointer;
+}
+
+// Release allocations
+void operator delete(void *Pointer) noexcept {
+	free(Pointer);
+}
+
+// Play a game with a policy for a number of ticks
+void Advance(_Game &Game, _Policy &Policy, int Ticks) {
+	for(int i = 0; i < Ticks && Game.State == STATE_PLAY; i++) {
+		_Input Input;
+		Input.Jump = Policy.Jump(Game);
+		Game.Step(Input);
+	}
+}
+
+// Play a game with a policy, returning the ticks it jumped on
+std::vector<uint32_t> PlayRecorded(_Game &Game, _Policy &Policy, uint32_t Seed) {
+	std::vector<uint32_t> Jumps;
+	Game.Init(Seed);
+	Policy.Reset(Seed);
+	while(Game.State == STATE_PLAY) {
+		_Input Input;
+		Input.Jump = Policy.Jump(Game);
+		uint32_t Tick = Game.Ticks;
+		if(Game.Step(Input) & EVENT_JUMP)
+			Jumps.push_back(Tick);
+	}
+
+	return Jumps;
+}
+
+// Decide a jump for one batch lane the way _FollowPolicy does
+bool GetBatchFollowJump(const _Batch &Batch, int Lane) {
+	float GapX, GapY;
+	if(!Batch.GetNextGap(Lane, GapX, GapY))
+		GapY = Batch.ScreenHeight / 2;
+
+	float Bottom = GapY + SPACING - PLAYER_RADIUS;
+	float NextY = Batch.PlayerY[Lane] + (Batch.VelocityY[Lane] + GRAVITY * GAME_TIMESTEP) * GAME_TIMESTEP;
+
+	return Batch.VelocityY[Lane] > 0.0f && NextY >= Bottom;
+}
+
+// Decide a jump the way _FollowPolicy does, but jumping once within a margin of the gap's bottom
+bool GetGameFollowJump(const _Game &Game, float Margin) {
+	const _Physics &Physics = Game.Player.Physics;
+
+	float GapX, GapY;
+	if(!Game.GetNextGap(GapX, GapY))
+		GapY = Game.ScreenHeight / 2;
+
+	float Bottom = GapY + SPACING - Game.Player.Radius;
+	float NextY = Physics.GetPosition().Y + (Physics.GetVelocity().Y + GRAVITY * GAME_TIMESTEP) * GAME_TIMESTEP;
+
+	return Physics.GetVelocity().Y > 0.0f && NextY >= Bottom - Margin;
+}
+
+// Start a server thread and open its shared memory
+bool StartServer(const std::string &Name, int EnvCount, std::thread &Server, _ServeChannel &Channel) {
+	Server = std::thread(RunServe, Name, EnvCount, true);
+	for(int i = 0; i < 1000; i++) {
+		if(Channel.Open(Name))
+			return true;
+
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+
+	return false;
+}
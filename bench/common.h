@@ -0,0 +1,44 @@
+/******************************************************************************
+* openflap
+* Copyright (C) 2014  Alan Witkowski
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*******************************************************************************/
+#pragma once
+
+// Libraries
+#include <stdint.h>
+#include <vector>
+#include <string>
+#include <thread>
+
+// Location of fonts and images
+#ifndef BENCH_DATA_PATH
+#define BENCH_DATA_PATH "working/"
+#endif
+
+// Forward declarations
+class _Game;
+class _Batch;
+class _Policy;
+class _ServeChannel;
+
+// Number of heap allocations made by the process
+extern uint64_t AllocationCount;
+
+void Advance(_Game &Game, _Policy &Policy, int Ticks);
+std::vector<uint32_t> PlayRecorded(_Game &Game, _Policy &Policy, uint32_t Seed);
+bool GetBatchFollowJump(const _Batch &Batch, int Lane);
+bool GetGameFollowJump(const _Game &Game, float Margin);
+bool StartServer(const std::string &Name, int EnvCount, std::thread &Server, _ServeChannel &Channel);
@@ -0,0 +1,811 @@
+/******************************************************************************
+* openflap
+* Copyright (C) 2014  Alan Witkowski
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*******************************************************************************/
+#include "common.h"
+#include <game.h>
+#include <batch.h>
+#include <openflap.h>
+#include <serve.h>
+#include <raster.h>
+#include <population.h>
+#include <policy.h>
+#include <render.h>
+#include <assets.h>
+#include <capture.h>
+#include <replay.h>
+#include <physics.h>
+#include <textbuffer.h>
+#include <constants.h>
+#include <SDL.h>
+#include <SDL_ttf.h>
+#include <SDL_image.h>
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <algorithm>
+#include <vector>
+#include <string>
+#include <cmath>
+#include <cstring>
+#include <thread>
+#ifdef __linux__
+	#include <unistd.h>
+	#include <sys/wait.h>
+#endif
+
+const double TEST_INTEGRATOR_MAX_ERROR = 0.05;
+const int TEST_FORMAT_COUNT = 1000;
+const int TEST_REPLAY_SEEDS = 200;
+const int TEST_SWEEP_COUNT = 100000;
+const int TEST_SWEEP_SAMPLES = 1000;
+const int TEST_SWEPT_SEEDS = 2000;
+const int TEST_SWEPT_TICKS_PER_STEP = 5;
+const int TEST_BATCH_LANES = 256;
+const int TEST_BATCH_STEPS = 2000;
+const int TEST_WIDE_SCREEN_WIDTH = 1920;
+const int TEST_CAPI_ENVS = 256;
+const int TEST_SERVE_ENVS = 64;
+const int TEST_SERVE_STEPS = 2000;
+const int TEST_SERVE_RACE_ROUNDS = 10;
+const int TEST_POPULATION_PLAYERS = 256;
+const int TEST_POPULATION_SEEDS = 4;
+const int TEST_CAPTURE_WIDTH = 806;
+const int TEST_CAPTURE_HEIGHT = 60;
+const int TEST_RENDER_WARMUP = 10;
+const int TEST_RENDER_FRAMES = 100;
+const int TEST_RASTER_SIZE = 84;
+const double TEST_RASTER_MAX_DIFF = 16.0;
+const double TEST_RASTER_MAX_REGION_DIFF = 6.0;
+const int TEST_RASTER_HUD_WIDTH = 160;
+const int TEST_RASTER_HUD_HEIGHT = 120;
+const float TEST_RASTER_PLAYER_INSET = 4.0f;
+const char *TEST_RASTER_REGIONS[3] = { "wall", "gap", "player" };
+
+// Get largest distance between an integrated jump arc and the exact solution
+static double GetTrajectoryError(IntegratorType Integrator) {
+	const double StartY = 300.0;
+	_Physics Physics(Vector2(100.0f, (float)StartY), Vector2(0.0f, JUMP_POWER), Vector2(0.0f, GRAVITY));
+	Physics.SetIntegrator(Integrator);
+
+	double MaxError = 0.0;
+	for(int Tick = 1; Tick <= (int)(2.0f / GAME_TIMESTEP); Tick++) {
+		Physics.Update(GAME_TIMESTEP);
+
+		double Time = Tick * (double)GAME_TIMESTEP;
+		double ExactY = StartY + JUMP_POWER * Time + 0.5 * GRAVITY * Time * Time;
+		double Error = std::abs(Physics.GetPosition().Y - ExactY);
+		if(Error > MaxError)
+			MaxError = Error;
+	}
+
+	return MaxError;
+}
+
+// Check that exact integrators stay on the analytic jump arc; Euler drifts by design
+static bool CheckIntegrators() {
+	const IntegratorType Integrators[] = { INTEGRATOR_RK4, INTEGRATOR_ANALYTIC };
+	const char *Names[] = { "rk4", "analytic" };
+
+	bool Passed = true;
+	for(int i = 0; i < 2; i++) {
+		double Error = GetTrajectoryError(Integrators[i]);
+		bool Match = Error < TEST_INTEGRATOR_MAX_ERROR;
+		Passed &= Match;
+
+		std::cout << "integrator=" << Names[i] << std::setprecision(4) << " max_error=" << Error << (Match ? " ok" : " FAIL") << std::endl;
+	}
+
+	return Passed;
+}
+
+// Check that formatting HUD lines never allocates
+static bool CheckFormat() {
+	float Time = 0.0f;
+	uint64_t Allocations = AllocationCount;
+	for(int i = 0; i < TEST_FORMAT_COUNT; i++) {
+		_TextBuffer Buffer;
+		Buffer.Append("Time: ").Append(Time, 2);
+
+		Buffer.Clear();
+		Buffer.Append("Seed: ").Append((uint32_t)i);
+		Time += GAME_TIMESTEP;
+	}
+	Allocations = AllocationCount - Allocations;
+
+	bool Passed = Allocations == 0;
+	std::cout << "format count=" << TEST_FORMAT_COUNT << " allocations=" << Allocations << (Passed ? " ok" : " FAIL") << std::endl;
+
+	return Passed;
+}
+
+// Check that restoring a snapshot reproduces the same future
+static bool CheckSnapshot() {
+	_Game Game(DEFAULT_SCREEN_WIDTH, DEFAULT_SCREEN_HEIGHT);
+	_FollowPolicy Policy;
+	Game.Init(0);
+	Advance(Game, Policy, 500);
+
+	// Play to the end twice from the same snapshot
+	_GameState Snapshot;
+	float Scores[2];
+	uint32_t Ticks[2];
+	Game.Save(Snapshot);
+	for(int Run = 0; Run < 2; Run++) {
+		Game.Restore(Snapshot);
+		while(Game.State == STATE_PLAY) {
+			_Input Input;
+			Input.Jump = Policy.Jump(Game);
+			Game.Step(Input);
+		}
+		Scores[Run] = Game.Time;
+		Ticks[Run] = Game.Ticks;
+	}
+
+	bool Passed = Scores[0] == Scores[1] && Ticks[0] == Ticks[1];
+	std::cout << "snapshot replay_ticks=" << Ticks[0] << "," << Ticks[1] << (Passed ? " ok" : " FAIL") << std::endl;
+
+	return Passed;
+}
+
+// Record games and check that they verify, unless their screen size or tick count was tampered with
+static bool CheckReplays() {
+	_Game Game(DEFAULT_SCREEN_WIDTH, DEFAULT_SCREEN_HEIGHT);
+	_FollowPolicy Policy;
+	int Verified = 0, WrongGeometry = 0, Bounded = 0;
+	std::vector<uint8_t> Data;
+	for(uint32_t Seed = 0; Seed < TEST_REPLAY_SEEDS; Seed++) {
+		_Replay Replay;
+		Game.Init(Seed);
+		Replay.Start(Game);
+		while(Game.State == STATE_PLAY) {
+			_Input Input;
+			Input.Jump = Policy.Jump(Game);
+			uint32_t Tick = Game.Ticks;
+			if(Game.Step(Input) & EVENT_JUMP)
+				Replay.RecordJump(Tick, 0);
+		}
+		Replay.Finish(Game);
+
+		// Check the file as read back
+		_Replay Loaded;
+		Replay.Encode(Data);
+		Verified += Loaded.Decode(Data.data(), Data.size()) && Loaded.Verify(Game);
+
+		// Claim a wider screen, where the same jumps might score differently
+		_Replay Tampered = Replay;
+		Tampered.ScreenWidth = TEST_WIDE_SCREEN_WIDTH;
+		Tampered.Encode(Data);
+		WrongGeometry += Loaded.Decode(Data.data(), Data.size()) && !Loaded.Play(Game) && !Loaded.Verify(Game);
+
+		// Claim far more ticks than a zero score allows, which stops the run while it's still alive
+		Tampered = Replay;
+		Tampered.Ticks = UINT32_MAX;
+		Tampered.Score = 0.0f;
+		Bounded += Tampered.Play(Game) && Game.State == STATE_PLAY && Game.Ticks == Tampered.GetTickLimit();
+	}
+
+	bool Passed = Verified == TEST_REPLAY_SEEDS && WrongGeometry == TEST_REPLAY_SEEDS && Bounded == TEST_REPLAY_SEEDS;
+	std::cout << "replay verified=" << Verified << "/" << TEST_REPLAY_SEEDS << " wrong_geometry=" << WrongGeometry << "/" << TEST_REPLAY_SEEDS;
+	std::cout << " bounded=" << Bounded << "/" << TEST_REPLAY_SEEDS << (Passed ? " ok" : " FAIL") << std::endl;
+
+	return Passed;
+}
+
+// Check swept collision against dense sampling, then check that coarse steps end games like single ticks
+static bool CheckSwept() {
+
+	// Sweep random circles past a box and find the first sample that touches it
+	uint32_t State = 1;
+	auto Random = [&State](float Low, float High) {
+		State = State * 1664525u + 1013904223u;
+		return Low + (High - Low) * (State >> 8) / 16777216.0f;
+	};
+	int Hits = 0, Misses = 0;
+	for(int i = 0; i < TEST_SWEEP_COUNT; i++) {
+		Vector2 Start(Random(0.0f, 200.0f), Random(0.0f, 200.0f));
+		Vector2 End(Random(0.0f, 200.0f), Random(0.0f, 200.0f));
+		float Radius = Random(1.0f, 30.0f);
+		float Left = Random(50.0f, 100.0f), Top = Random(50.0f, 100.0f);
+		float Right = Left + Random(1.0f, 50.0f), Bottom = Top + Random(1.0f, 50.0f);
+
+		_Player Player;
+		Player.Radius = Radius;
+		int FirstSample = -1;
+		for(int Sample = 0; Sample <= TEST_SWEEP_SAMPLES && FirstSample < 0; Sample++) {
+			float Fraction = (float)Sample / TEST_SWEEP_SAMPLES;
+			Player.Physics.SetPosition(Start + (End - Start) * Fraction);
+			if(_Game::CheckWallCollision(Player, Left, Top, Right, Bottom))
+				FirstSample = Sample;
+		}
+
+		// The impact must come before the first touching sample and after the last clear one
+		float Impact;
+		bool Hit = _Game::SweepWallCollision(Start, End, Radius, Left, Top, Right, Bottom, Impact);
+		if(FirstSample >= 0) {
+			Hits++;
+			if(!Hit || Impact > (float)FirstSample / TEST_SWEEP_SAMPLES + 1e-4f || Impact < (float)(FirstSample - 1) / TEST_SWEEP_SAMPLES - 1e-4f)
+				Misses++;
+		}
+	}
+
+	// Record each game's jumps at the coarse rate and play them back in a game stepping one tick at a time
+	_Game Coarse(DEFAULT_SCREEN_WIDTH, DEFAULT_SCREEN_HEIGHT);
+	_Game Fine(DEFAULT_SCREEN_WIDTH, DEFAULT_SCREEN_HEIGHT);
+	Coarse.TicksPerStep = TEST_SWEPT_TICKS_PER_STEP;
+	_FollowPolicy Policy;
+	int Same = 0;
+	for(uint32_t Seed = 0; Seed < TEST_SWEPT_SEEDS; Seed++) {
+		std::vector<uint32_t> Jumps = PlayRecorded(Coarse, Policy, Seed);
+
+		Fine.Init(Seed);
+		size_t Jump = 0;
+		while(Fine.State == STATE_PLAY) {
+			_Input Input;
+			Input.Jump = Jump < Jumps.size() && Jumps[Jump] == Fine.Ticks;
+			if(Input.Jump)
+				Jump++;
+			Fine.Step(Input);
+		}
+
+		Same += Coarse.Ticks == Fine.Ticks && Coarse.Death == Fine.Death && Coarse.Time == Fine.Time;
+	}
+
+	bool Equivalent = Same == TEST_SWEPT_SEEDS;
+	std::cout << "sweep hits=" << Hits << " misses=" << Misses << (Misses == 0 ? " ok" : " FAIL") << std::endl;
+	std::cout << "swept ticks_per_step=" << TEST_SWEPT_TICKS_PER_STEP << " same=" << Same << "/" << TEST_SWEPT_SEEDS << (Equivalent ? " ok" : " FAIL") << std::endl;
+
+	return Misses == 0 && Equivalent;
+}
+
+// Play each lane's first game with the follow policy and count the lanes that end like _Game
+static int CheckBatchLanes(int Lanes, int ScreenWidth) {
+	_Batch Batch(Lanes, ScreenWidth, DEFAULT_SCREEN_HEIGHT);
+	std::vector<uint8_t> Jumps(Lanes);
+	std::vector<uint8_t> Finished(Lanes, 0);
+	std::vector<uint32_t> FinishedTicks(Lanes);
+	std::vector<float> FinishedTime(Lanes);
+	std::vector<uint8_t> FinishedDeath(Lanes);
+	int Remaining = Lanes;
+	Batch.Init(0);
+	while(Remaining) {
+		for(int Lane = 0; Lane < Lanes; Lane++)
+			Jumps[Lane] = GetBatchFollowJump(Batch, Lane);
+		Batch.Step(Jumps.data());
+		for(int Lane = 0; Lane < Lanes; Lane++) {
+			if(Batch.Done[Lane] && !Finished[Lane]) {
+				Finished[Lane] = 1;
+				FinishedTicks[Lane] = Batch.FinalTicks[Lane];
+				FinishedTime[Lane] = Batch.FinalTime[Lane];
+				FinishedDeath[Lane] = Batch.Death[Lane];
+				Remaining--;
+			}
+		}
+	}
+
+	int Same = 0;
+	_Game Game(ScreenWidth, DEFAULT_SCREEN_HEIGHT);
+	_FollowPolicy Policy;
+	for(int Lane = 0; Lane < Lanes; Lane++) {
+		Game.Init(Lane);
+		while(Game.State == STATE_PLAY) {
+			_Input Input;
+			Input.Jump = Policy.Jump(Game);
+			Game.Step(Input);
+		}
+		Same += Game.Ticks == FinishedTicks[Lane] && Game.Time == FinishedTime[Lane] && Game.Death == FinishedDeath[Lane];
+	}
+
+	return Same;
+}
+
+// Check that batch lanes play out like single games, and reset on the same steps as games stepped one by one
+static bool CheckBatch() {
+
+	// Compare lanes with single games, on a wide screen too where more walls fit
+	int Same = CheckBatchLanes(TEST_BATCH_LANES, DEFAULT_SCREEN_WIDTH);
+	int WideSame = CheckBatchLanes(TEST_BATCH_LANES, TEST_WIDE_SCREEN_WIDTH);
+
+	// Step with a fixed jump pattern, so lanes die and reset along the way
+	std::vector<uint8_t> Pattern(TEST_BATCH_LANES * 24);
+	for(size_t i = 0; i < Pattern.size(); i++)
+		Pattern[i] = (i * 2654435761u >> 16) % 24 == 0;
+
+	_Batch Lanes(TEST_BATCH_LANES, DEFAULT_SCREEN_WIDTH, DEFAULT_SCREEN_HEIGHT);
+	std::vector<_Game> Games(TEST_BATCH_LANES, _Game(DEFAULT_SCREEN_WIDTH, DEFAULT_SCREEN_HEIGHT));
+	Lanes.Init(0);
+	for(int Lane = 0; Lane < TEST_BATCH_LANES; Lane++)
+		Games[Lane].Init(Lane);
+	int Ended = 0, GamesEnded = 0;
+	for(int Step = 0; Step < TEST_BATCH_STEPS; Step++) {
+		const uint8_t *StepJumps = &Pattern[(Step % 24) * TEST_BATCH_LANES];
+		Ended += Lanes.Step(StepJumps);
+		for(int Lane = 0; Lane < TEST_BATCH_LANES; Lane++) {
+			_Input Input;
+			Input.Jump = StepJumps[Lane];
+			if(Games[Lane].Step(Input) & EVENT_DIED) {
+				Games[Lane].Init(Games[Lane].Seed + TEST_BATCH_LANES);
+				GamesEnded++;
+			}
+		}
+	}
+
+	bool Passed = Same == TEST_BATCH_LANES && WideSame == TEST_BATCH_LANES && Ended == GamesEnded;
+	std::cout << "batch same=" << Same << "/" << TEST_BATCH_LANES << " wide_same=" << WideSame << "/" << TEST_BATCH_LANES;
+	std::cout << " ended=" << Ended << "," << GamesEnded << (Passed ? " ok" : " FAIL") << std::endl;
+
+	return Passed;
+}
+
+// Play through the C interface with the follow rule read from observations, checking each first game against _Game
+static bool CheckCapi() {
+	std::vector<uint32_t> Seeds(TEST_CAPI_ENVS);
+	for(int i = 0; i < TEST_CAPI_ENVS; i++)
+		Seeds[i] = 1000 + i * 7;
+
+	openflap_env *Env = openflap_create(TEST_CAPI_ENVS, Seeds.data());
+
+	// Calls without buffers or an environment fail instead of crashing
+	std::vector<uint8_t> Actions(TEST_CAPI_ENVS);
+	bool Guarded = openflap_step(Env, Actions.data()) == -1 && openflap_reset(Env, nullptr) == -1;
+	Guarded &= openflap_step(nullptr, Actions.data()) == -1 && openflap_reset(nullptr, nullptr) == -1;
+	Guarded &= openflap_get_result(nullptr, 0, nullptr, nullptr, nullptr, nullptr) == 0;
+
+	std::vector<float> Observations(TEST_CAPI_ENVS * OPENFLAP_OBSERVATION_SIZE);
+	std::vector<float> Rewards(TEST_CAPI_ENVS);
+	std::vector<uint8_t> Dones(TEST_CAPI_ENVS);
+	std::vector<float> Returns(TEST_CAPI_ENVS, 0.0f);
+	std::vector<float> Scores(TEST_CAPI_ENVS, -1.0f);
+	std::vector<uint32_t> Ticks(TEST_CAPI_ENVS);
+	std::vector<int> Deaths(TEST_CAPI_ENVS);
+	openflap_set_buffers(Env, Observations.data(), Rewards.data(), Dones.data());
+	Guarded &= openflap_step(Env, nullptr) == -1;
+
+	int Remaining = TEST_CAPI_ENVS;
+	uint64_t Steps = 0;
+	uint64_t Allocations = AllocationCount;
+	while(Remaining) {
+		for(int i = 0; i < TEST_CAPI_ENVS; i++) {
+			const float *Observation = &Observations[i * OPENFLAP_OBSERVATION_SIZE];
+			float Y = Observation[OPENFLAP_OBSERVATION_PLAYER_Y];
+			float VelocityY = Observation[OPENFLAP_OBSERVATION_VELOCITY_Y];
+			float Bottom = Observation[OPENFLAP_OBSERVATION_GAP_Y] + SPACING - PLAYER_RADIUS;
+			float NextY = Y + (VelocityY + GRAVITY * GAME_TIMESTEP) * GAME_TIMESTEP;
+			Actions[i] = VelocityY > 0.0f && NextY >= Bottom;
+		}
+		openflap_step(Env, Actions.data());
+		Steps++;
+
+		for(int i = 0; i < TEST_CAPI_ENVS; i++) {
+			if(Scores[i] >= 0.0f)
+				continue;
+
+			Returns[i] += Rewards[i];
+			if(Dones[i] && openflap_get_result(Env, i, &Scores[i], &Ticks[i], &Deaths[i], nullptr))
+				Remaining--;
+		}
+	}
+	Allocations = AllocationCount - Allocations;
+	openflap_destroy(Env);
+
+	int Same = 0;
+	_Game Game(DEFAULT_SCREEN_WIDTH, DEFAULT_SCREEN_HEIGHT);
+	_FollowPolicy Policy;
+	for(int i = 0; i < TEST_CAPI_ENVS; i++) {
+		Game.Init(Seeds[i]);
+		while(Game.State == STATE_PLAY) {
+			_Input Input;
+			Input.Jump = Policy.Jump(Game);
+			Game.Step(Input);
+		}
+		Same += Game.Ticks == Ticks[i] && Game.Time == Scores[i] && Game.Time == Returns[i] && Game.Death == Deaths[i];
+	}
+
+	bool Passed = Same == TEST_CAPI_ENVS && Allocations == 0 && Guarded;
+	std::cout << "capi version=" << openflap_api_version() << " same=" << Same << "/" << TEST_CAPI_ENVS << " steps=" << Steps;
+	std::cout << " guarded=" << Guarded;
+	std::cout << " allocations=" << Allocations << (Passed ? " ok" : " FAIL") << std::endl;
+
+	return Passed;
+}
+
+// Check that players in a population die like single games with the same jumps
+static bool CheckPopulation() {
+
+	// Give each player its own margin and compare it with a game playing the same rule
+	std::vector<float> Margins(TEST_POPULATION_PLAYERS);
+	for(int i = 0; i < TEST_POPULATION_PLAYERS; i++)
+		Margins[i] = POPULATION_MAX_MARGIN * i / TEST_POPULATION_PLAYERS;
+
+	// Check on a wide screen too, where more walls fit
+	const int Widths[2] = { DEFAULT_SCREEN_WIDTH, TEST_WIDE_SCREEN_WIDTH };
+	int Same = 0;
+	std::vector<uint8_t> Jumps(TEST_POPULATION_PLAYERS);
+	for(int Width : Widths) {
+		_Population Check(TEST_POPULATION_PLAYERS, Width, DEFAULT_SCREEN_HEIGHT);
+		_Game Game(Width, DEFAULT_SCREEN_HEIGHT);
+		for(uint32_t Seed = 0; Seed < TEST_POPULATION_SEEDS; Seed++) {
+			Check.Init(Seed);
+			while(Check.GetAlive()) {
+				Check.GetFollowJumps(Margins.data(), Jumps.data());
+				Check.Step(Jumps.data());
+			}
+
+			for(int i = 0; i < TEST_POPULATION_PLAYERS; i++) {
+				Game.Init(Seed);
+				while(Game.State == STATE_PLAY) {
+					_Input Input;
+					Input.Jump = GetGameFollowJump(Game, Margins[i]);
+					Game.Step(Input);
+				}
+				Same += Game.Ticks == Check.FinalTicks[i] && Game.Time == Check.FinalTime[i] && Game.Death == Check.Death[i];
+			}
+		}
+	}
+
+	int Checks = 2 * TEST_POPULATION_PLAYERS * TEST_POPULATION_SEEDS;
+	bool Passed = Same == Checks;
+	std::cout << "population same=" << Same << "/" << Checks << (Passed ? " ok" : " FAIL") << std::endl;
+
+	return Passed;
+}
+
+// Check that a server waiting on a client that exited gives up, that a client waiting on a server
+// that exited gives up, and that a new server only replaces shared memory left by a dead one
+static bool CheckServePeers(const std::string &Name) {
+#ifdef __linux__
+
+	// Another server and another client can't take a running server's memory
+	int ServeResult = 0;
+	_ServeChannel Channel;
+	std::thread Server([&]() { ServeResult = RunServe(Name, 1, true); });
+	bool Opened = false;
+	for(int i = 0; i < 1000 && !Opened; i++) {
+		Opened = Channel.Open(Name);
+		if(!Opened)
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+	_ServeChannel Other;
+	bool Exclusive = Opened && !Other.Create(Name, 1) && !Other.Open(Name);
+	Channel.Close();
+
+	// A client process exits without quitting
+	pid_t Child = fork();
+	if(Child == 0)
+		_exit(Channel.Open(Name) ? 0 : 1);
+	int Status = 1;
+	if(Child > 0)
+		waitpid(Child, &Status, 0);
+	if(!Opened || Status != 0) {
+		Channel.Open(Name);
+		Channel.Call(SERVE_QUIT);
+		Channel.Close();
+	}
+	Server.join();
+	bool ServerGaveUp = Opened && Status == 0 && ServeResult == 1;
+
+	// A server process exits without cleaning up
+	Child = fork();
+	if(Child == 0)
+		_exit(Other.Create(Name, 1) ? 0 : 1);
+	Status = 1;
+	if(Child > 0)
+		waitpid(Child, &Status, 0);
+	bool ClientGaveUp = Status == 0 && Channel.Open(Name) && !Channel.Call(SERVE_STEP);
+	Channel.Close();
+	bool Replaced = Other.Create(Name, 1);
+	Other.Close();
+
+	// Start two server processes at the same moment, where only one may get the name
+	int Races = 0;
+	for(int Round = 0; Round < TEST_SERVE_RACE_ROUNDS; Round++) {
+		std::chrono::steady_clock::time_point Start = std::chrono::steady_clock::now() + std::chrono::milliseconds(20);
+		pid_t Children[2];
+		for(int i = 0; i < 2; i++) {
+			Children[i] = fork();
+			if(Children[i] == 0) {
+				while(std::chrono::steady_clock::now() < Start);
+				bool Created = Other.Create(Name, 1);
+				if(Created)
+					std::this_thread::sleep_for(std::chrono::milliseconds(50));
+				Other.Close();
+				_exit(Created ? 0 : 1);
+			}
+		}
+
+		int Created = 0, Waited = 0;
+		for(int i = 0; i < 2; i++) {
+			if(Children[i] > 0 && waitpid(Children[i], &Status, 0) == Children[i] && WIFEXITED(Status)) {
+				Created += WEXITSTATUS(Status) == 0;
+				Waited++;
+			}
+		}
+		Races += Waited == 2 && Created == 1 && !Channel.Open(Name);
+	}
+
+	bool Passed = Exclusive && ServerGaveUp && ClientGaveUp && Replaced && Races == TEST_SERVE_RACE_ROUNDS;
+	std::cout << "serve exclusive=" << Exclusive << " server_gave_up=" << ServerGaveUp << " client_gave_up=" << ClientGaveUp;
+	std::cout << " replaced=" << Replaced << " races=" << Races << "/" << TEST_SERVE_RACE_ROUNDS << (Passed ? " ok" : " FAIL") << std::endl;
+
+	return Passed;
+#else
+	return true;
+#endif
+}
+
+// Check a server thread's games against a local batch, then how servers and clients treat each other
+static bool CheckServe() {
+	std::string Name = "/openflap_test_" + std::to_string(std::chrono::steady_clock::now().time_since_epoch().count());
+
+	// Step the same random jumps on both sides and compare observations after every step
+	std::thread Server;
+	_ServeChannel Channel;
+	if(!StartServer(Name, TEST_SERVE_ENVS, Server, Channel)) {
+		std::cout << "serve unavailable" << std::endl;
+		if(Server.joinable())
+			Server.join();
+		return true;
+	}
+
+	_Batch Batch(TEST_SERVE_ENVS, DEFAULT_SCREEN_WIDTH, DEFAULT_SCREEN_HEIGHT);
+	for(int i = 0; i < TEST_SERVE_ENVS; i++)
+		Channel.Seeds[i] = 500 + i;
+	bool Same = Channel.Call(SERVE_RESET);
+	Batch.InitLanes(Channel.Seeds);
+
+	std::vector<float> Observations(TEST_SERVE_ENVS * _Batch::OBSERVATION_SIZE);
+	for(int Step = 0; Step < TEST_SERVE_STEPS && Same; Step++) {
+		for(int i = 0; i < TEST_SERVE_ENVS; i++)
+			Channel.Actions[i] = ((Step + i) * 2654435761u >> 16) % 20 == 0;
+		bool Called = Channel.Call(SERVE_STEP);
+		int Ended = Batch.Step(Channel.Actions);
+		Batch.GetObservations(Observations.data());
+		Same = Called && Ended == Channel.GetEnded() && !memcmp(Observations.data(), Channel.Observations, Observations.size() * sizeof(float));
+	}
+	Channel.Call(SERVE_QUIT);
+	Channel.Close();
+	Server.join();
+
+	std::cout << "serve envs=" << TEST_SERVE_ENVS << " steps=" << TEST_SERVE_STEPS << (Same ? " ok" : " FAIL") << std::endl;
+
+	return CheckServePeers(Name) && Same;
+}
+
+// Check that converting a frame to YUV matches the scalar formulas exactly, with a width that leaves pixels after the last vector
+static bool CheckCapture() {
+	int Width = TEST_CAPTURE_WIDTH, Height = TEST_CAPTURE_HEIGHT;
+	std::vector<uint8_t> Pixels(Width * Height * 4);
+	for(size_t i = 0; i < Pixels.size(); i++)
+		Pixels[i] = (uint8_t)(i * 2654435761u >> 24);
+
+	std::vector<uint8_t> Planes(Width * Height * 3 / 2);
+	uint8_t *PlaneY = Planes.data();
+	uint8_t *PlaneU = PlaneY + Width * Height;
+	uint8_t *PlaneV = PlaneU + Width * Height / 4;
+	_Capture::ConvertToYUV(Pixels.data(), Width, Height, PlaneY, PlaneU, PlaneV);
+
+	int Wrong = 0;
+	for(int Y = 0; Y < Height; Y++) {
+		for(int X = 0; X < Width; X++) {
+			const uint8_t *Pixel = &Pixels[(Y * Width + X) * 4];
+			Wrong += PlaneY[Y * Width + X] != (29 * Pixel[0] + 150 * Pixel[1] + 77 * Pixel[2] + 128) >> 8;
+		}
+	}
+	for(int Y = 0; Y < Height; Y += 2) {
+		for(int X = 0; X < Width; X += 2) {
+			int Sums[3];
+			for(int Channel = 0; Channel < 3; Channel++) {
+				const uint8_t *Pixel = &Pixels[(Y * Width + X) * 4 + Channel];
+				Sums[Channel] = (Pixel[0] + Pixel[4] + Pixel[Width * 4] + Pixel[Width * 4 + 4] + 2) >> 2;
+			}
+			int Index = Y / 2 * (Width / 2) + X / 2;
+			Wrong += PlaneU[Index] != ((128 * Sums[0] - 85 * Sums[1] - 43 * Sums[2] + 128) >> 8) + 128;
+			Wrong += PlaneV[Index] != ((-21 * Sums[0] - 107 * Sums[1] + 128 * Sums[2] + 128) >> 8) + 128;
+		}
+	}
+
+	bool Passed = Wrong == 0;
+	std::cout << "capture width=" << Width << " height=" << Height << " wrong=" << Wrong << (Passed ? " ok" : " FAIL") << std::endl;
+
+	return Passed;
+}
+
+// Check that frames with changing HUD text make no heap allocations once warmed up, while playing and after dying
+static bool CheckRenderAllocations(SDL_Renderer *Renderer, _Render &Render, const _Game &Game) {
+	_Game Died(Game);
+	while(Died.State == STATE_PLAY)
+		Died.Step(_Input());
+
+	for(int i = 0; i < TEST_RENDER_WARMUP; i++) {
+		Render.Draw(Game, 12.34f, 0.5f);
+		Render.Draw(Died, 12.34f, 0.5f);
+	}
+
+	uint64_t Allocations = AllocationCount;
+	for(int i = 0; i < TEST_RENDER_FRAMES; i++) {
+		Render.Draw(i % 2 ? Died : Game, 12.34f + i, 0.5f);
+		SDL_RenderPresent(Renderer);
+	}
+	Allocations = AllocationCount - Allocations;
+
+	bool Passed = Allocations == 0;
+	std::cout << "render frames=" << TEST_RENDER_FRAMES << " allocations=" << Allocations << (Passed ? " ok" : " FAIL") << std::endl;
+
+	return Passed;
+}
+
+// Get the region a box of screen pixels lies fully inside: 0 for a wall, 1 for a gap away from the player, 2 for the player, or -1
+static int GetRasterRegion(const _Game &Game, int Left, int Top, int Right, int Bottom) {
+
+	// Skip the text in the corner
+	if(Right > Game.ScreenWidth - TEST_RASTER_HUD_WIDTH && Top < TEST_RASTER_HUD_HEIGHT)
+		return -1;
+
+	float PlayerX = Game.Player.Physics.GetPosition().X;
+	float PlayerY = Game.Player.Physics.GetPosition().Y;
+	float Radius = Game.Player.Radius - TEST_RASTER_PLAYER_INSET;
+	float FarX = std::max(std::abs(Left - PlayerX), std::abs(Right - PlayerX));
+	float FarY = std::max(std::abs(Top - PlayerY), std::abs(Bottom - PlayerY));
+	if(FarX * FarX + FarY * FarY <= Radius * Radius)
+		return 2;
+
+	bool NearPlayer = Right > PlayerX - Game.Player.Radius && Left < PlayerX + Game.Player.Radius && Bottom > PlayerY - Game.Player.Radius && Top < PlayerY + Game.Player.Radius;
+	for(int i = 0; i + 1 < Game.Walls.GetCount(); i += 2) {
+		int Upper = Game.Walls.GetIndex(i);
+		int Lower = Game.Walls.GetIndex(i + 1);
+		float WallLeft = (int)(Game.Walls.X[Upper] + 0.5f);
+		if(Left < WallLeft || Right > WallLeft + Game.Walls.Width[Upper])
+			continue;
+
+		float UpperTop = (int)(Game.Walls.Y[Upper] + 0.5f);
+		float GapTop = UpperTop + Game.Walls.Height[Upper];
+		float GapBottom = (int)(Game.Walls.Y[Lower] + 0.5f);
+		if((Top >= UpperTop && Bottom <= GapTop) || (Top >= GapBottom && Bottom <= GapBottom + Game.Walls.Height[Lower]))
+			return 0;
+		if(Top >= GapTop && Bottom <= GapBottom && !NearPlayer)
+			return 1;
+	}
+
+	return -1;
+}
+
+// Compare the rasterizer against a frame from the renderer, converted to luma and box filtered down to the same size.
+// Over the whole frame the error is bounded, and inside walls, gaps and the player the average shades must agree.
+static bool CheckRaster(SDL_Renderer *Renderer, _Render &Render, const _Game &Game) {
+	std::vector<uint8_t> Pixels(DEFAULT_SCREEN_WIDTH * DEFAULT_SCREEN_HEIGHT * 4);
+	Render.Draw(Game, 12.34f, 1.0f);
+	if(SDL_RenderReadPixels(Renderer, nullptr, SDL_PIXELFORMAT_ARGB8888, Pixels.data(), DEFAULT_SCREEN_WIDTH * 4) != 0) {
+		std::cout << SDL_GetError() << std::endl;
+		return false;
+	}
+
+	std::vector<uint8_t> Frame(TEST_RASTER_SIZE * TEST_RASTER_SIZE);
+	_Raster Raster(TEST_RASTER_SIZE, TEST_RASTER_SIZE, DEFAULT_SCREEN_WIDTH, DEFAULT_SCREEN_HEIGHT);
+	Raster.Draw(Game, Frame.data());
+
+	double Total = 0.0;
+	int Worst = 0;
+	double RegionRendered[3] = { 0.0, 0.0, 0.0 };
+	double RegionRastered[3] = { 0.0, 0.0, 0.0 };
+	int RegionCells[3] = { 0, 0, 0 };
+	for(int Y = 0; Y < TEST_RASTER_SIZE; Y++) {
+		int Top = Y * DEFAULT_SCREEN_HEIGHT / TEST_RASTER_SIZE;
+		int Bottom = (Y + 1) * DEFAULT_SCREEN_HEIGHT / TEST_RASTER_SIZE;
+		for(int X = 0; X < TEST_RASTER_SIZE; X++) {
+			int Left = X * DEFAULT_SCREEN_WIDTH / TEST_RASTER_SIZE;
+			int Right = (X + 1) * DEFAULT_SCREEN_WIDTH / TEST_RASTER_SIZE;
+			int Sum = 0;
+			for(int i = Top; i < Bottom; i++) {
+				const uint8_t *Pixel = &Pixels[(i * DEFAULT_SCREEN_WIDTH + Left) * 4];
+				for(int j = Left; j < Right; j++, Pixel += 4)
+					Sum += (29 * Pixel[0] + 150 * Pixel[1] + 77 * Pixel[2] + 128) >> 8;
+			}
+
+			int Rendered = Sum / ((Bottom - Top) * (Right - Left));
+			int Rastered = Frame[Y * TEST_RASTER_SIZE + X];
+			int Difference = std::abs(Rendered - Rastered);
+			Total += Difference;
+			Worst = std::max(Worst, Difference);
+
+			int Region = GetRasterRegion(Game, Left, Top, Right, Bottom);
+			if(Region >= 0) {
+				RegionRendered[Region] += Rendered;
+				RegionRastered[Region] += Rastered;
+				RegionCells[Region]++;
+			}
+		}
+	}
+
+	double Mean = Total / (TEST_RASTER_SIZE * TEST_RASTER_SIZE);
+	bool Passed = Mean <= TEST_RASTER_MAX_DIFF;
+	std::cout << std::setprecision(2) << "raster size=" << TEST_RASTER_SIZE << " mean_diff=" << Mean << " max_diff=" << Worst;
+	for(int i = 0; i < 3; i++) {
+		double Difference = RegionCells[i] ? std::abs(RegionRendered[i] - RegionRastered[i]) / RegionCells[i] : 0.0;
+		Passed &= RegionCells[i] > 0 && Difference <= TEST_RASTER_MAX_REGION_DIFF;
+		std::cout << " " << TEST_RASTER_REGIONS[i] << "_cells=" << RegionCells[i] << " " << TEST_RASTER_REGIONS[i] << "_diff=" << Difference;
+	}
+	std::cout << (Passed ? " ok" : " FAIL") << std::endl;
+
+	return Passed;
+}
+
+// Draw with the software renderer and no window, checking allocations and the rasterizer against it
+static bool CheckRender() {
+	SDL_SetHint(SDL_HINT_VIDEODRIVER, "dummy");
+	if(SDL_Init(SDL_INIT_VIDEO) != 0 || TTF_Init() != 0 || !(IMG_Init(IMG_INIT_PNG) & IMG_INIT_PNG)) {
+		std::cout << SDL_GetError() << std::endl;
+		return false;
+	}
+
+	SDL_Window *Window = SDL_CreateWindow("openflap_test", 0, 0, DEFAULT_SCREEN_WIDTH, DEFAULT_SCREEN_HEIGHT, 0);
+	SDL_Renderer *Renderer = Window ? SDL_CreateRenderer(Window, -1, SDL_RENDERER_SOFTWARE) : nullptr;
+	if(!Renderer) {
+		std::cout << SDL_GetError() << std::endl;
+		SDL_Quit();
+		return false;
+	}
+
+	bool Passed = true;
+	{
+		_Assets Assets;
+		_Render Render;
+		Assets.Open(BENCH_DATA_PATH "openflap.pak", BENCH_DATA_PATH);
+		Assets.StartDecode();
+		if(Assets.FinishDecode() && Render.Load(Renderer, Assets)) {
+			Render.VersionText.Append("Version: ").Append(GAME_VERSION);
+			Render.SeedText.Append("Seed: ").Append((uint32_t)0);
+
+			// Draw a busy mid game frame
+			_Game Game(DEFAULT_SCREEN_WIDTH, DEFAULT_SCREEN_HEIGHT);
+			_FollowPolicy Policy;
+			Game.Init(0);
+			Advance(Game, Policy, 1000);
+			Passed &= CheckRenderAllocations(Renderer, Render, Game);
+			Passed &= CheckRaster(Renderer, Render, Game);
+		}
+		else {
+			std::cout << SDL_GetError() << std::endl;
+			Passed = false;
+		}
+	}
+
+	SDL_DestroyRenderer(Renderer);
+	SDL_DestroyWindow(Window);
+	IMG_Quit();
+	TTF_Quit();
+	SDL_Quit();
+
+	return Passed;
+}
+
+int main(int ArgumentCount, char **Arguments) {
+	bool Passed = true;
+	Passed &= CheckIntegrators();
+	Passed &= CheckFormat();
+	Passed &= CheckSnapshot();
+	Passed &= CheckReplays();
+	Passed &= CheckSwept();
+	Passed &= CheckBatch();
+	Passed &= CheckPopulation();
+	Passed &= CheckCapi();
+	Passed &= CheckServe();
+	Passed &= CheckCapture();
+	Passed &= CheckRender();
+
+	std::cout << (Passed ? "all ok" : "FAIL") << std::endl;
+
+	return Passed ? 0 : 1;
+}
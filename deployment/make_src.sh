@@ -6,7 +6,7 @@ gitver=`git log --oneline | wc -l`
 base=openflap-${version}r${gitver}
 pkg=${base}-src.tar.gz
 
-tar --transform "s,^,${base}/," -czvf ${pkg} -C ../ src/ working/ deployment/{openflap,openflap.desktop,openflap.png} cmake/ CMakeLists.txt README LICENSE --exclude=*.dll --exclude=*.exe --exclude=*.swp --exclude=*.nsi
+tar --transform "s,^,${base}/," -czvf ${pkg} -C ../ src/ bench/ tools/ working/ deployment/{openflap,openflap.desktop,openflap.png} cmake/ CMakeLists.txt README LICENSE --exclude=*.dll --exclude=*.exe --exclude=*.swp --exclude=*.nsi --exclude=*.pak
 
 echo -e "\nMade ${pkg}"
 
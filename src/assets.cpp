@@ -0,0 +1,107 @@
+/******************************************************************************
+* openflap
+* Copyright (C) 2014  Alan Witkowski
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*******************************************************************************/
+#include <assets.h>
+#include <workpool.h>
+#include <SDL_image.h>
+#include <algorithm>
+
+static const char *ImageNames[IMAGE_COUNT] = {
+	"image/player.png",
+	"image/wall.png",
+	"image/back0.png",
+	"image/back1.png",
+};
+
+// Constructor
+_Assets::_Assets() {
+	for(int i = 0; i < IMAGE_COUNT; i++)
+		Images[i] = nullptr;
+}
+
+// Destructor
+_Assets::~_Assets() {
+	Close();
+}
+
+// Map the pack, falling back to files in the directory when it's missing
+void _Assets::Open(const std::string &PackPath, const std::string &Directory) {
+	Close();
+	this->Directory = Directory;
+	Pack.Open(PackPath);
+}
+
+// Wait for decoding, free images and unmap the pack
+void _Assets::Close() {
+	if(Thread.joinable())
+		Thread.join();
+
+	FreeImages();
+	Pack.Close();
+}
+
+// Open a stream for a file, reading straight from the mapped pack when possible
+SDL_RWops *_Assets::OpenFile(const std::string &Name) const {
+	if(!Pack.IsOpen())
+		return SDL_RWFromFile((Directory + Name).c_str(), "rb");
+
+	const uint8_t *Data;
+	size_t Size;
+	if(!Pack.Find(Name, Data, Size)) {
+		SDL_SetError("%s not found in pack", Name.c_str());
+		return nullptr;
+	}
+
+	return SDL_RWFromConstMem(Data, (int)Size);
+}
+
+// Decode images while the caller keeps starting up.
+// IMG_Init must be called first since it isn't thread safe.
+void _Assets::StartDecode() {
+	Thread = std::thread([this]() {
+		_WorkPool Pool(std::min((int)IMAGE_COUNT, _WorkPool::GetDefaultThreadCount()));
+		Pool.Run(0, IMAGE_COUNT, 1, [this](int Worker, uint64_t Begin, uint64_t End) {
+			for(uint64_t i = Begin; i < End; i++) {
+				SDL_RWops *File = OpenFile(ImageNames[i]);
+				if(File)
+					Images[i] = IMG_Load_RW(File, 1);
+			}
+		});
+	});
+}
+
+// Wait for decoding to finish, returning false and setting Missing if a file failed
+bool _Assets::FinishDecode() {
+	if(Thread.joinable())
+		Thread.join();
+
+	Missing.clear();
+	for(int i = 0; i < IMAGE_COUNT; i++) {
+		if(!Images[i])
+			Missing = ImageNames[i];
+	}
+
+	return Missing.empty();
+}
+
+// Free decoded images once they're uploaded
+void _Assets::FreeImages() {
+	for(int i = 0; i < IMAGE_COUNT; i++) {
+		SDL_FreeSurface(Images[i]);
+		Images[i] = nullptr;
+	}
+}
@@ -0,0 +1,61 @@
+/******************************************************************************
+* openflap
+* Copyright (C) 2014  Alan Witkowski
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*******************************************************************************/
+#pragma once
+
+// Libraries
+#include <SDL.h>
+#include <pack.h>
+#include <string>
+#include <thread>
+
+// Images decoded at startup
+enum ImageType {
+	IMAGE_PLAYER,
+	IMAGE_WALL,
+	IMAGE_BACK0,
+	IMAGE_BACK1,
+	IMAGE_COUNT,
+};
+
+// Game data read from a pack, or loose files without one, with images decoded on worker threads
+class _Assets {
+
+	public:
+
+		_Assets();
+		~_Assets();
+
+		void Open(const std::string &PackPath, const std::string &Directory);
+		void Close();
+		bool IsPacked() const { return Pack.IsOpen(); }
+		SDL_RWops *OpenFile(const std::string &Name) const;
+
+		void StartDecode();
+		bool FinishDecode();
+		void FreeImages();
+
+		SDL_Surface *Images[IMAGE_COUNT];
+		std::string Missing;
+
+	private:
+
+		_Pack Pack;
+		std::string Directory;
+		std::thread Thread;
+
+};
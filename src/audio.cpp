@@ -0,0 +1,141 @@
+/******************************************************************************
+* openflap
+* Copyright (C) 2014  Alan Witkowski
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*******************************************************************************/
+#include <audio.h>
+#include <assets.h>
+
+static const char *SoundNames[SOUND_COUNT] = {
+	"audio/swoop.ogg",
+	"audio/pop.ogg",
+};
+
+// Constructor
+_Audio::_Audio() :
+	Assets(nullptr),
+	SoundVolume(1.0f),
+	MusicVolume(1.0f),
+	Music(nullptr),
+	Initialized(false),
+	Opened(false),
+	Ready(false),
+	Loaded(false) {
+
+	for(int i = 0; i < SOUND_COUNT; i++)
+		Sounds[i] = nullptr;
+}
+
+// Destructor
+_Audio::~_Audio() {
+	Close();
+}
+
+// Start opening the device and loading data without blocking the caller.
+// Mix_Init loads the decoders lazily and isn't thread safe, so it's called here first.
+void _Audio::Start(const _Assets &Assets, const std::string &MusicName, float SoundVolume, float MusicVolume) {
+	this->Assets = &Assets;
+	this->MusicName = MusicName;
+	this->SoundVolume = SoundVolume;
+	this->MusicVolume = MusicVolume;
+
+	int MixFlags = MIX_INIT_OGG;
+	Initialized = (Mix_Init(MixFlags) & MixFlags) == MixFlags;
+	if(!Initialized)
+		Error = Mix_GetError();
+
+	Thread = std::thread(&_Audio::Load, this);
+}
+
+// Start the music once loading has finished, returning true on that call
+bool _Audio::Update() {
+	if(Ready || !Thread.joinable() || !Loaded.load(std::memory_order_acquire))
+		return false;
+
+	Thread.join();
+	if(!Error.empty())
+		return true;
+
+	// Play sounds even when the music is missing
+	Mix_Volume(-1, (int)(SoundVolume * MIX_MAX_VOLUME));
+	Mix_VolumeMusic((int)(MusicVolume * MIX_MAX_VOLUME));
+	if(Music && Mix_PlayMusic(Music, -1) == -1)
+		MusicError = Mix_GetError();
+
+	Ready = true;
+
+	return true;
+}
+
+// Wait for loading, then free sounds and close the device
+void _Audio::Close() {
+	if(Thread.joinable())
+		Thread.join();
+
+	for(int i = 0; i < SOUND_COUNT; i++) {
+		Mix_FreeChunk(Sounds[i]);
+		Sounds[i] = nullptr;
+	}
+	if(Music) {
+		Mix_FreeMusic(Music);
+		Music = nullptr;
+	}
+	if(Opened) {
+		Mix_CloseAudio();
+		Opened = false;
+	}
+	if(Initialized) {
+		Mix_Quit();
+		Initialized = false;
+	}
+	Ready = false;
+}
+
+// Play a sound effect, ignored until audio is ready
+void _Audio::Play(SoundType Sound) {
+	if(Ready && Sounds[Sound])
+		Mix_PlayChannel(-1, Sounds[Sound], 0);
+}
+
+// Open the device and decode sounds on the background thread.
+// The music is streamed from the pack while it plays.
+void _Audio::Load() {
+	if(!Initialized) {
+		Loaded.store(true, std::memory_order_release);
+		return;
+	}
+
+	if(SDL_InitSubSystem(SDL_INIT_AUDIO) != 0) {
+		Error = SDL_GetError();
+		Loaded.store(true, std::memory_order_release);
+		return;
+	}
+
+	if(Mix_OpenAudio(44100, MIX_DEFAULT_FORMAT, 2, 1024) < 0) {
+		Error = Mix_GetError();
+		Loaded.store(true, std::memory_order_release);
+		return;
+	}
+	Opened = true;
+
+	for(int i = 0; i < SOUND_COUNT; i++)
+		Sounds[i] = Mix_LoadWAV_RW(Assets->OpenFile(SoundNames[i]), 1);
+
+	Music = Mix_LoadMUS_RW(Assets->OpenFile(MusicName), 1);
+	if(!Music)
+		MusicError = Mix_GetError();
+
+	Loaded.store(true, std::memory_order_release);
+}
@@ -0,0 +1,74 @@
+/******************************************************************************
+* openflap
+* Copyright (C) 2014  Alan Witkowski
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*******************************************************************************/
+#pragma once
+
+// Libraries
+#include <SDL_mixer.h>
+#include <atomic>
+#include <string>
+#include <thread>
+
+// Forward declarations
+class _Assets;
+
+// Sounds played by the game
+enum SoundType {
+	SOUND_JUMP,
+	SOUND_DIE,
+	SOUND_COUNT,
+};
+
+// Opens the audio device and loads sounds and music on a background thread
+class _Audio {
+
+	public:
+
+		_Audio();
+		~_Audio();
+
+		void Start(const _Assets &Assets, const std::string &MusicName, float SoundVolume, float MusicVolume);
+		bool Update();
+		void Close();
+
+		void Play(SoundType Sound);
+
+		bool IsReady() const { return Ready; }
+		const std::string &GetError() const { return Error; }
+		const std::string &GetMusicError() const { return MusicError; }
+
+	private:
+
+		void Load();
+
+		const _Assets *Assets;
+		std::string MusicName;
+		float SoundVolume;
+		float MusicVolume;
+
+		Mix_Chunk *Sounds[SOUND_COUNT];
+		Mix_Music *Music;
+		std::string Error;
+		std::string MusicError;
+		bool Initialized;
+		bool Opened;
+		bool Ready;
+
+		std::thread Thread;
+		std::atomic<bool> Loaded;
+
+};
@@ -0,0 +1,265 @@
+/******************************************************************************
+* openflap
+* Copyright (C) 2014  Alan Witkowski
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*******************************************************************************/
+#include <batch.h>
+#include <game.h>
+#include <constants.h>
+#include <xmmintrin.h>
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+// Start the state the way std::mt19937 does, filling the rest only as draws reach it
+void _BatchRandom::Seed(uint32_t Seed) {
+	State[0] = Seed;
+	Filled = 1;
+	Index = 0;
+}
+
+// Twist the next word in place, which is the same order std::mt19937 twists the whole state in
+_BatchRandom::result_type _BatchRandom::operator()() {
+	int Next = Index + 1 < SIZE ? Index + 1 : 0;
+	int Far = Index + 397 < SIZE ? Index + 397 : Index + 397 - SIZE;
+	for(int Last = std::max(Next, Far); Filled <= Last; Filled++)
+		State[Filled] = 1812433253u * (State[Filled - 1] ^ (State[Filled - 1] >> 30)) + Filled;
+
+	uint32_t Y = (State[Index] & 0x80000000u) | (State[Next] & 0x7fffffffu);
+	State[Index] = State[Far] ^ (Y >> 1) ^ ((Y & 1) ? 0x9908b0dfu : 0);
+
+	Y = State[Index];
+	Index = Next;
+	Y ^= Y >> 11;
+	Y ^= (Y << 7) & 0x9d2c5680u;
+	Y ^= (Y << 15) & 0xefc60000u;
+	Y ^= Y >> 18;
+
+	return Y;
+}
+
+// Constructor
+_Batch::_Batch(int Count, int ScreenWidth, int ScreenHeight) :
+	ScreenWidth(ScreenWidth),
+	ScreenHeight(ScreenHeight),
+	Count(Count),
+	PaddedCount((Count + WIDTH - 1) / WIDTH * WIDTH),
+	WallSlots(CountWallSlots(ScreenWidth)),
+	Steps(0) {
+
+	Seeds.resize(PaddedCount);
+	StartSteps.resize(PaddedCount);
+	Time.resize(PaddedCount);
+	SpawnTimer.resize(PaddedCount);
+	PlayerY.resize(PaddedCount);
+	VelocityY.resize(PaddedCount);
+	WallX.assign(WallSlots, std::vector<float>(PaddedCount));
+	WallTopBottom.assign(WallSlots, std::vector<float>(PaddedCount));
+	WallBottomTop.assign(WallSlots, std::vector<float>(PaddedCount));
+	WallBottomBottom.assign(WallSlots, std::vector<float>(PaddedCount));
+	Done.resize(PaddedCount);
+	Death.resize(PaddedCount);
+	FinalTicks.resize(PaddedCount);
+	FinalTime.resize(PaddedCount);
+	RandomGenerators.resize(PaddedCount);
+}
+
+// Get the number of wall pairs that can be on a screen at once, plus one for a pair spawning as another leaves
+int _Batch::CountWallSlots(int ScreenWidth) {
+	return (int)std::ceil((ScreenWidth + WALL_WIDTH) / (-WALL_VELOCITY * SPAWNTIME)) + 1;
+}
+
+// Start every lane, giving lane i the seeds FirstSeed + i, then + Count for each game after that
+void _Batch::Init(uint32_t FirstSeed) {
+	std::vector<uint32_t> LaneSeeds(Count);
+	for(int Lane = 0; Lane < Count; Lane++)
+		LaneSeeds[Lane] = FirstSeed + Lane;
+
+	InitLanes(LaneSeeds.data());
+}
+
+// Start every lane with its own seed, adding Count for each game after that
+void _Batch::InitLanes(const uint32_t *LaneSeeds) {
+	Steps = 0;
+	for(int Lane = 0; Lane < PaddedCount; Lane++) {
+		Reset(Lane, Lane < Count ? LaneSeeds[Lane] : 0);
+		Done[Lane] = 0;
+		Death[Lane] = DEATH_NONE;
+		FinalTicks[Lane] = 0;
+		FinalTime[Lane] = 0.0f;
+	}
+}
+
+// Start a new game in one lane, matching _Game::Init
+void _Batch::Reset(int Lane, uint32_t Seed) {
+	Seeds[Lane] = Seed;
+	RandomGenerators[Lane].Seed(Seed);
+	StartSteps[Lane] = Steps;
+	Time[Lane] = 0.0f;
+	SpawnTimer[Lane] = 0.0f;
+	PlayerY[Lane] = 0.0f;
+	VelocityY[Lane] = 0.0f;
+	for(int i = 0; i < WallSlots; i++)
+		WallX[i][Lane] = BATCH_NO_WALL;
+}
+
+// Add a wall pair at the right edge of the screen, matching _Game::SpawnWall.
+// Slots are sized from the screen width, so one is always free.
+void _Batch::SpawnWall(int Lane) {
+	std::uniform_real_distribution<double> Distribution(ScreenHeight/2 - SPAWN_RANGE, ScreenHeight/2 + SPAWN_RANGE);
+	float MidY = (float)Distribution(RandomGenerators[Lane]);
+	for(int i = 0; i < WallSlots; i++) {
+		if(WallX[i][Lane] != BATCH_NO_WALL)
+			continue;
+
+		float BottomTop = MidY + SPACING;
+		WallX[i][Lane] = (float)ScreenWidth;
+		WallTopBottom[i][Lane] = 0.0f + (int)(MidY - SPACING);
+		WallBottomTop[i][Lane] = BottomTop;
+		WallBottomBottom[i][Lane] = BottomTop + (int)(ScreenHeight - BottomTop);
+		return;
+	}
+}
+
+// Advance every lane one tick with a jump flag per lane, returning the number of games that ended
+int _Batch::Step(const uint8_t *Jumps) {
+
+	// Fourth order Runge-Kutta under constant gravity, with the same operations as _Physics
+	const float HalfStep = GAME_TIMESTEP * 0.5f;
+	const float VelocityChange = (GRAVITY + (GRAVITY + GRAVITY) * 2.0f + GRAVITY) * (1.0f / 6.0f);
+	const __m128 Zero = _mm_setzero_ps();
+	const __m128 Two = _mm_set1_ps(2.0f);
+	const __m128 Sixth = _mm_set1_ps(1.0f / 6.0f);
+	const __m128 TimeStep = _mm_set1_ps(GAME_TIMESTEP);
+	const __m128 GravityHalfStep = _mm_set1_ps(GRAVITY * HalfStep);
+	const __m128 GravityStep = _mm_set1_ps(GRAVITY * GAME_TIMESTEP);
+	const __m128 VelocityStep = _mm_set1_ps(VelocityChange * GAME_TIMESTEP);
+	const __m128 JumpPower = _mm_set1_ps(JUMP_POWER);
+	const __m128 WallStep = _mm_set1_ps(WALL_VELOCITY * GAME_TIMESTEP);
+	const __m128 WallWidth = _mm_set1_ps((float)(int)WALL_WIDTH);
+	const __m128 NoWall = _mm_set1_ps(BATCH_NO_WALL);
+	const __m128 PlayerX = _mm_set1_ps(PLAYER_X);
+	const __m128 RadiusSquared = _mm_set1_ps(PLAYER_RADIUS * PLAYER_RADIUS);
+	const __m128 FallY = _mm_set1_ps(ScreenHeight + PLAYER_RADIUS);
+
+	Steps++;
+	std::fill(Done.begin(), Done.end(), 0);
+
+	int Ended = 0;
+	for(int Lane = 0; Lane < PaddedCount; Lane += WIDTH) {
+
+		// Jump by replacing the velocity
+		float Flags[WIDTH];
+		for(int i = 0; i < WIDTH; i++)
+			Flags[i] = Lane + i < Count && Jumps[Lane + i];
+		__m128 JumpMask = _mm_cmpneq_ps(_mm_loadu_ps(Flags), Zero);
+		__m128 Velocity = _mm_loadu_ps(&VelocityY[Lane]);
+		Velocity = _mm_or_ps(_mm_and_ps(JumpMask, JumpPower), _mm_andnot_ps(JumpMask, Velocity));
+
+		// Integrate and keep the player below the ceiling
+		__m128 Y = _mm_loadu_ps(&PlayerY[Lane]);
+		__m128 Middle = _mm_add_ps(Velocity, GravityHalfStep);
+		__m128 Change = _mm_add_ps(Velocity, _mm_mul_ps(_mm_add_ps(Middle, Middle), Two));
+		Change = _mm_mul_ps(_mm_add_ps(Change, _mm_add_ps(Velocity, GravityStep)), Sixth);
+		Y = _mm_add_ps(Y, _mm_mul_ps(Change, TimeStep));
+		Y = _mm_max_ps(Y, Zero);
+		Velocity = _mm_add_ps(Velocity, VelocityStep);
+		_mm_storeu_ps(&PlayerY[Lane], Y);
+		_mm_storeu_ps(&VelocityY[Lane], Velocity);
+		_mm_storeu_ps(&Time[Lane], _mm_add_ps(_mm_loadu_ps(&Time[Lane]), TimeStep));
+		__m128 Timer = _mm_sub_ps(_mm_loadu_ps(&SpawnTimer[Lane]), TimeStep);
+		_mm_storeu_ps(&SpawnTimer[Lane], Timer);
+
+		// Scroll walls, freeing slots that leave the screen, and test the player against the moved walls
+		__m128 WallHit = Zero;
+		for(int i = 0; i < WallSlots; i++) {
+			__m128 Left = _mm_add_ps(_mm_loadu_ps(&WallX[i][Lane]), WallStep);
+			__m128 Right = _mm_add_ps(Left, WallWidth);
+			__m128 Gone = _mm_cmplt_ps(Right, Zero);
+			Left = _mm_or_ps(_mm_and_ps(Gone, NoWall), _mm_andnot_ps(Gone, Left));
+			Right = _mm_add_ps(Left, WallWidth);
+			_mm_storeu_ps(&WallX[i][Lane], Left);
+
+			__m128 DistanceX = _mm_sub_ps(_mm_min_ps(_mm_max_ps(PlayerX, Left), Right), PlayerX);
+			__m128 DistanceXSquared = _mm_mul_ps(DistanceX, DistanceX);
+			__m128 TopY = _mm_min_ps(Y, _mm_loadu_ps(&WallTopBottom[i][Lane]));
+			__m128 BottomY = _mm_min_ps(_mm_max_ps(Y, _mm_loadu_ps(&WallBottomTop[i][Lane])), _mm_loadu_ps(&WallBottomBottom[i][Lane]));
+			__m128 TopDistance = _mm_sub_ps(TopY, Y);
+			__m128 BottomDistance = _mm_sub_ps(BottomY, Y);
+			WallHit = _mm_or_ps(WallHit, _mm_cmplt_ps(_mm_add_ps(DistanceXSquared, _mm_mul_ps(TopDistance, TopDistance)), RadiusSquared));
+			WallHit = _mm_or_ps(WallHit, _mm_cmplt_ps(_mm_add_ps(DistanceXSquared, _mm_mul_ps(BottomDistance, BottomDistance)), RadiusSquared));
+		}
+
+		// Leave spawns, deaths and resets to scalar code
+		int WallMask = _mm_movemask_ps(WallHit);
+		int FallMask = _mm_movemask_ps(_mm_cmpgt_ps(Y, FallY));
+		int SpawnMask = _mm_movemask_ps(_mm_cmple_ps(Timer, Zero));
+		if(!(WallMask | FallMask | SpawnMask))
+			continue;
+
+		for(int i = 0; i < WIDTH; i++) {
+			int Index = Lane + i;
+			if(SpawnMask & (1 << i)) {
+				SpawnWall(Index);
+				SpawnTimer[Index] = SPAWNTIME;
+			}
+
+			if((WallMask | FallMask) & (1 << i)) {
+				Done[Index] = 1;
+				Death[Index] = (WallMask & (1 << i)) ? DEATH_WALL : DEATH_FALL;
+				FinalTicks[Index] = GetTicks(Index);
+				FinalTime[Index] = Time[Index];
+				Reset(Index, Seeds[Index] + Count);
+				Ended += Index < Count;
+			}
+		}
+	}
+
+	return Ended;
+}
+
+// Get the position of the nearest wall gap that the player hasn't passed in a lane, matching _Game::GetNextGap
+bool _Batch::GetNextGap(int Lane, float &GapX, float &GapY) const {
+	float PlayerLeft = PLAYER_X - PLAYER_RADIUS;
+	bool Found = false;
+	for(int i = 0; i < WallSlots; i++) {
+		float X = WallX[i][Lane];
+		if(X == BATCH_NO_WALL || X + (int)WALL_WIDTH < PlayerLeft || (Found && X >= GapX))
+			continue;
+
+		GapX = X;
+		GapY = (WallTopBottom[i][Lane] + WallBottomTop[i][Lane]) * 0.5f;
+		Found = true;
+	}
+
+	return Found;
+}
+
+// Write each lane's observation
+void _Batch::GetObservations(float *Observations) const {
+	for(int Lane = 0; Lane < Count; Lane++) {
+		float GapX, GapY;
+		if(!GetNextGap(Lane, GapX, GapY)) {
+			GapX = (float)ScreenWidth;
+			GapY = ScreenHeight / 2;
+		}
+
+		Observations[0] = PlayerY[Lane];
+		Observations[1] = VelocityY[Lane];
+		Observations[2] = GapX - PLAYER_X;
+		Observations[3] = GapY;
+		Observations += OBSERVATION_SIZE;
+	}
+}
@@ -0,0 +1,111 @@
+/******************************************************************************
+* openflap
+* Copyright (C) 2014  Alan Witkowski
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*******************************************************************************/
+#pragma once
+
+// Libraries
+#include <stdint.h>
+#include <vector>
+
+// Position of unused wall slots
+const float BATCH_NO_WALL = 1.0e9f;
+
+// Same numbers as std::mt19937, but the state is seeded and twisted a word at a time as it's drawn,
+// so a game that only draws a few numbers doesn't pay for the whole state
+class _BatchRandom {
+
+	public:
+
+		typedef uint32_t result_type;
+
+		static constexpr result_type min() { return 0; }
+		static constexpr result_type max() { return 0xffffffff; }
+
+		void Seed(uint32_t Seed);
+		result_type operator()();
+
+	private:
+
+		static const int SIZE = 624;
+
+		uint32_t State[SIZE];
+		int Filled;
+		int Index;
+
+};
+
+// Many games stepped in lockstep, with each value stored as an array over lanes so four lanes update at once.
+// Lanes that die are reset with their next seed in the same step.
+class _Batch {
+
+	public:
+
+		// Lanes per SSE register
+		static const int WIDTH = 4;
+
+		// Floats per lane from GetObservations: player Y, velocity, distance to the next gap and the gap's Y
+		static const int OBSERVATION_SIZE = 4;
+
+		_Batch(int Count, int ScreenWidth, int ScreenHeight);
+
+		static int CountWallSlots(int ScreenWidth);
+
+		void Init(uint32_t FirstSeed);
+		void InitLanes(const uint32_t *LaneSeeds);
+		int Step(const uint8_t *Jumps);
+
+		int GetCount() const { return Count; }
+		int GetWallSlots() const { return WallSlots; }
+		uint32_t GetTicks(int Lane) const { return Steps - StartSteps[Lane]; }
+		bool GetNextGap(int Lane, float &GapX, float &GapY) const;
+		void GetObservations(float *Observations) const;
+
+		// Lane state
+		std::vector<uint32_t> Seeds;
+		std::vector<float> Time;
+		std::vector<float> SpawnTimer;
+		std::vector<float> PlayerY;
+		std::vector<float> VelocityY;
+
+		// Wall pairs by slot then lane, with unused slots far off screen
+		std::vector<std::vector<float> > WallX;
+		std::vector<std::vector<float> > WallTopBottom;
+		std::vector<std::vector<float> > WallBottomTop;
+		std::vector<std::vector<float> > WallBottomBottom;
+
+		// Lanes that ended in the last step, before they were reset
+		std::vector<uint8_t> Done;
+		std::vector<uint8_t> Death;
+		std::vector<uint32_t> FinalTicks;
+		std::vector<float> FinalTime;
+
+		// Attributes
+		int ScreenWidth, ScreenHeight;
+
+	private:
+
+		void Reset(int Lane, uint32_t Seed);
+		void SpawnWall(int Lane);
+
+		int Count;
+		int PaddedCount;
+		int WallSlots;
+		uint32_t Steps;
+		std::vector<uint32_t> StartSteps;
+		std::vector<_BatchRandom> RandomGenerators;
+
+};
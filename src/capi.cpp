@@ -0,0 +1,170 @@
+/******************************************************************************
+* openflap
+* Copyright (C) 2014  Alan Witkowski
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*******************************************************************************/
+#include <openflap.h>
+#include <batch.h>
+#include <raster.h>
+#include <constants.h>
+#include <memory>
+#include <new>
+#include <vector>
+
+// Games and the caller's buffers
+struct openflap_env {
+	openflap_env(int Count) : Batch(Count, DEFAULT_SCREEN_WIDTH, DEFAULT_SCREEN_HEIGHT), Observations(nullptr), Rewards(nullptr), Dones(nullptr) { }
+
+	_Batch Batch;
+	std::unique_ptr<_Raster> Raster;
+	std::vector<uint32_t> Seeds;
+	float *Observations;
+	float *Rewards;
+	uint8_t *Dones;
+};
+
+static_assert(_Batch::OBSERVATION_SIZE == OPENFLAP_OBSERVATION_SIZE, "Observation layouts must match");
+
+// Write each game's observation into the caller's buffer
+static void WriteObservations(openflap_env *Env) {
+	if(Env->Observations)
+		Env->Batch.GetObservations(Env->Observations);
+}
+
+// Check that an environment exists and has buffers to write into
+static bool IsReady(const openflap_env *Env) {
+	return Env && Env->Observations;
+}
+
+int openflap_api_version(void) {
+	return OPENFLAP_API_VERSION;
+}
+
+openflap_env *openflap_create(int n_envs, const uint32_t *seeds) {
+	if(n_envs <= 0)
+		return nullptr;
+
+	openflap_env *Env = nullptr;
+	try {
+		Env = new openflap_env(n_envs);
+		Env->Seeds.resize(n_envs);
+	}
+	catch(const std::bad_alloc &) {
+		delete Env;
+		return nullptr;
+	}
+
+	for(int i = 0; i < n_envs; i++)
+		Env->Seeds[i] = seeds ? seeds[i] : (uint32_t)i;
+	Env->Batch.InitLanes(Env->Seeds.data());
+
+	return Env;
+}
+
+void openflap_destroy(openflap_env *env) {
+	delete env;
+}
+
+int openflap_set_buffers(openflap_env *env, float *observations, float *rewards, uint8_t *dones) {
+	if(!env || !observations)
+		return -1;
+
+	env->Observations = observations;
+	env->Rewards = rewards;
+	env->Dones = dones;
+	WriteObservations(env);
+
+	return 0;
+}
+
+int openflap_reset(openflap_env *env, const uint32_t *seeds) {
+	if(!IsReady(env))
+		return -1;
+
+	int Count = env->Batch.GetCount();
+	if(seeds)
+		env->Seeds.assign(seeds, seeds + Count);
+	env->Batch.InitLanes(env->Seeds.data());
+
+	if(env->Rewards) {
+		for(int i = 0; i < Count; i++)
+			env->Rewards[i] = 0.0f;
+	}
+	if(env->Dones) {
+		for(int i = 0; i < Count; i++)
+			env->Dones[i] = 0;
+	}
+	WriteObservations(env);
+
+	return 0;
+}
+
+int openflap_step(openflap_env *env, const uint8_t *actions) {
+	if(!IsReady(env) || !actions)
+		return -1;
+
+	int Ended = env->Batch.Step(actions);
+
+	int Count = env->Batch.GetCount();
+	if(env->Rewards) {
+		for(int i = 0; i < Count; i++)
+			env->Rewards[i] = GAME_TIMESTEP;
+	}
+	if(env->Dones) {
+		for(int i = 0; i < Count; i++)
+			env->Dones[i] = env->Batch.Done[i];
+	}
+	WriteObservations(env);
+
+	return Ended;
+}
+
+int openflap_get_result(const openflap_env *env, int i, float *score, uint32_t *ticks, int *death, uint32_t *seed) {
+	if(!env)
+		return 0;
+
+	const _Batch &Batch = env->Batch;
+	if(i < 0 || i >= Batch.GetCount() || !Batch.Done[i])
+		return 0;
+
+	if(score)
+		*score = Batch.FinalTime[i];
+	if(ticks)
+		*ticks = Batch.FinalTicks[i];
+	if(death)
+		*death = Batch.Death[i];
+	if(seed)
+		*seed = Batch.Seeds[i] - (uint32_t)Batch.GetCount();
+
+	return 1;
+}
+
+int openflap_render(openflap_env *env, int width, int height, uint8_t *frames) {
+	if(!env || width <= 0 || height <= 0 || !frames)
+		return -1;
+
+	// Build the background rows once per frame size
+	if(!env->Raster || env->Raster->GetWidth() != width || env->Raster->GetHeight() != height) {
+		try {
+			env->Raster.reset(new _Raster(width, height, DEFAULT_SCREEN_WIDTH, DEFAULT_SCREEN_HEIGHT));
+		}
+		catch(const std::bad_alloc &) {
+			return -1;
+		}
+	}
+	env->Raster->Draw(env->Batch, 0, env->Batch.GetCount(), frames);
+
+	return 0;
+}
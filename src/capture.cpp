@@ -0,0 +1,229 @@
+/******************************************************************************
+* openflap
+* Copyright (C) 2014  Alan Witkowski
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*******************************************************************************/
+#include <capture.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+// Constructor
+_Capture::_Capture() :
+	Width(0),
+	Height(0),
+	Head(0),
+	Count(0),
+	Done(false),
+	Frames(0),
+	Dropped(0) {
+}
+
+// Destructor
+_Capture::~_Capture() {
+	Close();
+}
+
+// Open the output file, allocate frame slots and start the worker
+bool _Capture::Open(const std::string &Path, int Width, int Height, int FPS) {
+	if(Width <= 0 || Height <= 0 || Width % 2 || Height % 2)
+		return false;
+
+	File.open(Path.c_str(), std::ios::binary);
+	if(!File)
+		return false;
+
+	this->Width = Width;
+	this->Height = Height;
+	for(int i = 0; i < QUEUE_SIZE; i++)
+		Slots[i].resize(Width * Height * 4);
+	Planes.resize(Width * Height * 3 / 2);
+	Head = Count = 0;
+	Done = false;
+	Frames = Dropped = 0;
+
+	// Full range BT.601 4:2:0
+	File << "YUV4MPEG2 W" << Width << " H" << Height << " F" << FPS << ":1 Ip A1:1 C420jpeg\n";
+
+	Thread = std::thread(&_Capture::Work, this);
+
+	return true;
+}
+
+// Write remaining frames and stop the worker
+void _Capture::Close() {
+	if(!Thread.joinable())
+		return;
+
+	{
+		std::lock_guard<std::mutex> Lock(Mutex);
+		Done = true;
+	}
+	Condition.notify_one();
+	Thread.join();
+	File.close();
+}
+
+// Get a free slot to read pixels into, or null when the worker is behind
+uint8_t *_Capture::GetFrame() {
+	std::lock_guard<std::mutex> Lock(Mutex);
+	if(Count == QUEUE_SIZE) {
+		Dropped++;
+		return nullptr;
+	}
+
+	return Slots[(Head + Count) % QUEUE_SIZE].data();
+}
+
+// Queue the slot returned by GetFrame
+void _Capture::Submit() {
+	{
+		std::lock_guard<std::mutex> Lock(Mutex);
+		Count++;
+		Frames++;
+	}
+	Condition.notify_one();
+}
+
+// Convert and write queued frames in order
+void _Capture::Work() {
+	uint8_t *Y = Planes.data();
+	uint8_t *U = Y + Width * Height;
+	uint8_t *V = U + Width * Height / 4;
+
+	for(;;) {
+		const uint8_t *Pixels;
+		{
+			std::unique_lock<std::mutex> Lock(Mutex);
+			Condition.wait(Lock, [this]() { return Count > 0 || Done; });
+			if(!Count)
+				return;
+
+			Pixels = Slots[Head].data();
+		}
+
+		// The slot stays owned by the worker until it's released below
+		ConvertToYUV(Pixels, Width, Height, Y, U, V);
+		File << "FRAME\n";
+		File.write((const char *)Planes.data(), Planes.size());
+
+		std::lock_guard<std::mutex> Lock(Mutex);
+		Head = (Head + 1) % QUEUE_SIZE;
+		Count--;
+	}
+}
+
+// Convert one ARGB8888 pixel to luma
+static inline uint8_t GetLuma(const uint8_t *Pixel) {
+	return (uint8_t)((29 * Pixel[0] + 150 * Pixel[1] + 77 * Pixel[2] + 128) >> 8);
+}
+
+// Convert the average of a 2x2 block to chroma
+static inline void GetChroma(const uint8_t *Row0, const uint8_t *Row1, uint8_t &U, uint8_t &V) {
+	int B = (Row0[0] + Row0[4] + Row1[0] + Row1[4] + 2) >> 2;
+	int G = (Row0[1] + Row0[5] + Row1[1] + Row1[5] + 2) >> 2;
+	int R = (Row0[2] + Row0[6] + Row1[2] + Row1[6] + 2) >> 2;
+	U = (uint8_t)(((128 * B - 85 * G - 43 * R + 128) >> 8) + 128);
+	V = (uint8_t)(((-21 * B - 107 * G + 128 * R + 128) >> 8) + 128);
+}
+
+#ifdef __SSE2__
+
+// Multiply BGRA lanes of four pixels by coefficients and return one sum per pixel
+static inline __m128i DotPixels(__m128i Pixels, __m128i Coefficients) {
+	__m128i Zero = _mm_setzero_si128();
+	__m128i Low = _mm_madd_epi16(_mm_unpacklo_epi8(Pixels, Zero), Coefficients);
+	__m128i High = _mm_madd_epi16(_mm_unpackhi_epi8(Pixels, Zero), Coefficients);
+	__m128 Even = _mm_shuffle_ps(_mm_castsi128_ps(Low), _mm_castsi128_ps(High), _MM_SHUFFLE(2, 0, 2, 0));
+	__m128 Odd = _mm_shuffle_ps(_mm_castsi128_ps(Low), _mm_castsi128_ps(High), _MM_SHUFFLE(3, 1, 3, 1));
+
+	return _mm_add_epi32(_mm_castps_si128(Even), _mm_castps_si128(Odd));
+}
+
+// Average the two 2x2 blocks in four pixels of two rows, summing in 16 bit lanes to round like GetChroma
+static inline __m128i AverageBlocks(__m128i Row0, __m128i Row1) {
+	__m128i Zero = _mm_setzero_si128();
+	__m128i Low = _mm_add_epi16(_mm_unpacklo_epi8(Row0, Zero), _mm_unpacklo_epi8(Row1, Zero));
+	__m128i High = _mm_add_epi16(_mm_unpackhi_epi8(Row0, Zero), _mm_unpackhi_epi8(Row1, Zero));
+	Low = _mm_add_epi16(Low, _mm_shuffle_epi32(Low, _MM_SHUFFLE(1, 0, 3, 2)));
+	High = _mm_add_epi16(High, _mm_shuffle_epi32(High, _MM_SHUFFLE(1, 0, 3, 2)));
+
+	return _mm_srli_epi16(_mm_add_epi16(_mm_unpacklo_epi64(Low, High), _mm_set1_epi16(2)), 2);
+}
+
+#endif
+
+// Convert a frame to full range BT.601 planes, averaging 2x2 blocks for chroma
+void _Capture::ConvertToYUV(const uint8_t *Pixels, int Width, int Height, uint8_t *Y, uint8_t *U, uint8_t *V) {
+	int Pitch = Width * 4;
+	for(int Row = 0; Row < Height; Row += 2) {
+		const uint8_t *Row0 = Pixels + Row * Pitch;
+		const uint8_t *Row1 = Row0 + Pitch;
+		uint8_t *Y0 = Y + Row * Width;
+		uint8_t *Y1 = Y0 + Width;
+		uint8_t *RowU = U + Row / 2 * (Width / 2);
+		uint8_t *RowV = V + Row / 2 * (Width / 2);
+
+		int X = 0;
+#ifdef __SSE2__
+
+		// Eight pixels from each row give eight luma per row and four chroma
+		const __m128i LumaCoefficients = _mm_setr_epi16(29, 150, 77, 0, 29, 150, 77, 0);
+		const __m128i UCoefficients = _mm_setr_epi16(128, -85, -43, 0, 128, -85, -43, 0);
+		const __m128i VCoefficients = _mm_setr_epi16(-21, -107, 128, 0, -21, -107, 128, 0);
+		const __m128i Round = _mm_set1_epi32(128);
+		const __m128i Offset = _mm_set1_epi16(128);
+		for(; X + 8 <= Width; X += 8) {
+			__m128i A0 = _mm_loadu_si128((const __m128i *)(Row0 + X * 4));
+			__m128i B0 = _mm_loadu_si128((const __m128i *)(Row0 + X * 4 + 16));
+			__m128i A1 = _mm_loadu_si128((const __m128i *)(Row1 + X * 4));
+			__m128i B1 = _mm_loadu_si128((const __m128i *)(Row1 + X * 4 + 16));
+
+			// Luma
+			__m128i LumaA0 = _mm_srli_epi32(_mm_add_epi32(DotPixels(A0, LumaCoefficients), Round), 8);
+			__m128i LumaB0 = _mm_srli_epi32(_mm_add_epi32(DotPixels(B0, LumaCoefficients), Round), 8);
+			__m128i LumaA1 = _mm_srli_epi32(_mm_add_epi32(DotPixels(A1, LumaCoefficients), Round), 8);
+			__m128i LumaB1 = _mm_srli_epi32(_mm_add_epi32(DotPixels(B1, LumaCoefficients), Round), 8);
+			__m128i Luma0 = _mm_packs_epi32(LumaA0, LumaB0);
+			__m128i Luma1 = _mm_packs_epi32(LumaA1, LumaB1);
+			_mm_storel_epi64((__m128i *)(Y0 + X), _mm_packus_epi16(Luma0, Luma0));
+			_mm_storel_epi64((__m128i *)(Y1 + X), _mm_packus_epi16(Luma1, Luma1));
+
+			// Average each 2x2 block, four in all
+			__m128i Blocks = _mm_packus_epi16(AverageBlocks(A0, A1), AverageBlocks(B0, B1));
+			__m128i ChromaU = _mm_srai_epi32(_mm_add_epi32(DotPixels(Blocks, UCoefficients), Round), 8);
+			__m128i ChromaV = _mm_srai_epi32(_mm_add_epi32(DotPixels(Blocks, VCoefficients), Round), 8);
+			__m128i Chroma = _mm_add_epi16(_mm_packs_epi32(ChromaU, ChromaV), Offset);
+			Chroma = _mm_packus_epi16(Chroma, Chroma);
+
+			uint32_t PackedU = (uint32_t)_mm_cvtsi128_si32(Chroma);
+			uint32_t PackedV = (uint32_t)_mm_cvtsi128_si32(_mm_srli_si128(Chroma, 4));
+			for(int i = 0; i < 4; i++) {
+				RowU[X / 2 + i] = (uint8_t)(PackedU >> (i * 8));
+				RowV[X / 2 + i] = (uint8_t)(PackedV >> (i * 8));
+			}
+		}
+#endif
+
+		// Remaining pixels
+		for(; X < Width; X += 2) {
+			Y0[X] = GetLuma(Row0 + X * 4);
+			Y0[X + 1] = GetLuma(Row0 + X * 4 + 4);
+			Y1[X] = GetLuma(Row1 + X * 4);
+			Y1[X + 1] = GetLuma(Row1 + X * 4 + 4);
+			GetChroma(Row0 + X * 4, Row1 + X * 4, RowU[X / 2], RowV[X / 2]);
+		}
+	}
+}
@@ -0,0 +1,68 @@
+/******************************************************************************
+* openflap
+* Copyright (C) 2014  Alan Witkowski
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*******************************************************************************/
+#pragma once
+
+// Libraries
+#include <stdint.h>
+#include <condition_variable>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Writes ARGB frames to a YUV4MPEG2 file, converting and writing on a worker thread
+class _Capture {
+
+	public:
+
+		static const int QUEUE_SIZE = 8;
+
+		_Capture();
+		~_Capture();
+
+		bool Open(const std::string &Path, int Width, int Height, int FPS);
+		void Close();
+
+		bool IsOpen() const { return Thread.joinable(); }
+		uint8_t *GetFrame();
+		void Submit();
+
+		int GetPitch() const { return Width * 4; }
+		uint64_t GetFrames() const { return Frames; }
+		uint64_t GetDropped() const { return Dropped; }
+
+		static void ConvertToYUV(const uint8_t *Pixels, int Width, int Height, uint8_t *Y, uint8_t *U, uint8_t *V);
+
+	private:
+
+		void Work();
+
+		std::ofstream File;
+		std::thread Thread;
+		std::mutex Mutex;
+		std::condition_variable Condition;
+		std::vector<uint8_t> Slots[QUEUE_SIZE];
+		std::vector<uint8_t> Planes;
+		int Width, Height;
+		int Head, Count;
+		bool Done;
+		uint64_t Frames;
+		uint64_t Dropped;
+
+};
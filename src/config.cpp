@@ -57,6 +57,7 @@ void _Config::SetDefaults() {
 	ScreenHeight = DEFAULT_SCREEN_HEIGHT;
 	Fullscreen = DEFAULT_FULLSCREEN;
 	Vsync = DEFAULT_VSYNC;
+	PacerSpin = DEFAULT_PACER_SPIN;
 	AudioEnabled = DEFAULT_AUDIOENABLED;
 
 	SoundVolume = DEFAULT_SOUNDVOLUME;
@@ -97,6 +98,7 @@ void _Config::Load() {
 	GetValue("screen_height", ScreenHeight);
 	GetValue("fullscreen", Fullscreen);
 	GetValue("vsync", Vsync);
+	GetValue("pacer_spin", PacerSpin);
 	GetValue("audio_enabled", AudioEnabled);
 	GetValue("sound_volume", SoundVolume);
 	GetValue("music_volume", MusicVolume);
@@ -116,6 +118,7 @@ void _Config::Save() {
 	Out << "screen_height=" << ScreenHeight << std::endl;
 	Out << "fullscreen=" << Fullscreen << std::endl;
 	Out << "vsync=" << Vsync << std::endl;
+	Out << "pacer_spin=" << PacerSpin << std::endl;
 	Out << "audio_enabled=" << AudioEnabled << std::endl;
 	Out << "sound_volume=" << SoundVolume << std::endl;
 	Out << "music_volume=" << MusicVolume << std::endl;
@@ -40,6 +40,7 @@ class _Config {
 		// Graphics
 		int ScreenWidth, ScreenHeight;
 		int Vsync;
+		float PacerSpin;
 		bool Fullscreen;
 
 		// Audio
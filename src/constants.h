@@ -25,6 +25,7 @@
 const  int          DEFAULT_SCREEN_WIDTH           = 800;
 const  int          DEFAULT_SCREEN_HEIGHT          = 600;
 const  int          DEFAULT_VSYNC                  = 1;
+const  float        DEFAULT_PACER_SPIN             = 2.0f;
 const  bool         DEFAULT_FULLSCREEN             = false;
 const  bool         DEFAULT_AUDIOENABLED           = true;
 const  float        DEFAULT_SOUNDVOLUME            = 1.0f;
@@ -35,7 +36,11 @@ const  std::string  GAME_WINDOWTITLE               = "openflap";
 const  float        GAME_FPS                       = 100.0f;
 const  float        GAME_MAXFPS                    = 300.0f;
 const  float        GAME_TIMESTEP                  = 1.0f/GAME_FPS;
+const  int          CAPTURE_FPS                    = 50;
+const  int          INPUT_SUBTICKS                 = 256;
 
+const  float        PLAYER_X                       = 100.0f;
+const  float        PLAYER_RADIUS                  = 32.0f;
 const  float        JUMP_POWER                     = -670.0f;
 const  float        GRAVITY                        = 1600.0f;
 const  float        DIED_WAIT_TIME                 = 0.3f;
@@ -44,3 +49,25 @@ const  float        WALL_WIDTH                     = 100.0f;
 const  float        SPACING                        = 105.0f;
 const  float        SPAWNTIME                      = 1.6f;
 const  float        SPAWN_RANGE                    = 145.0f;
+
+//     Planner
+const  int          PLANNER_WIDTH                  = 64;
+const  int          PLANNER_DEPTH                  = 150;
+const  int          PLANNER_COOLDOWN               = 8;
+const  float        PLANNER_MERGE_DISTANCE         = 1.0f;
+const  float        PLANNER_MERGE_VELOCITY         = 1.0f;
+const  double       PLANNER_BUDGET                 = 0.001;
+
+//     Raster, with the average luma of bands of each image
+const  int          RASTER_SKY_SHADES[8]           = { 115, 109, 108, 115, 127, 137, 133, 126 };
+const  int          RASTER_HILL_SHADE              = 26;
+const  float        RASTER_HILL_TOP                = 0.49f;
+const  int          RASTER_WALL_SHADES[8]          = { 75, 108, 139, 163, 139, 110, 76, 44 };
+const  int          RASTER_PLAYER_SHADE            = 135;
+
+//     Population
+const  float        POPULATION_MAX_MARGIN          = 140.0f;
+const  int          GHOST_ALPHA                    = 48;
+
+//     Serve
+const  int          SERVE_DEFAULT_ENVS             = 1024;
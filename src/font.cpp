@@ -0,0 +1,102 @@
+/******************************************************************************
+* openflap
+* Copyright (C) 2014  Alan Witkowski
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*******************************************************************************/
+#include <font.h>
+
+// Destructor
+_Font::~_Font() {
+	if(Texture)
+		SDL_DestroyTexture(Texture);
+}
+
+// Rasterize printable ASCII glyphs into a single texture
+bool _Font::Load(SDL_Renderer *Renderer, TTF_Font *Font) {
+	this->Renderer = Renderer;
+	Height = TTF_FontHeight(Font);
+
+	// Render each glyph
+	SDL_Surface *Surfaces[GLYPH_COUNT];
+	const SDL_Color White = { 255, 255, 255, 255 };
+	int X = 0, Y = 0;
+	for(int i = 0; i < GLYPH_COUNT; i++) {
+		Uint16 Character = (Uint16)(GLYPH_FIRST + i);
+		int MinX, MaxX, MinY, MaxY, Advance;
+		if(TTF_GlyphMetrics(Font, Character, &MinX, &MaxX, &MinY, &MaxY, &Advance) != 0)
+			Advance = 0;
+
+		Surfaces[i] = TTF_RenderGlyph_Blended(Font, Character, White);
+		int Width = Surfaces[i] ? Surfaces[i]->w : 0;
+
+		// Wrap to next row of the atlas
+		if(X + Width > ATLAS_WIDTH) {
+			X = 0;
+			Y += Height;
+		}
+
+		Glyphs[i].Bounds.x = X;
+		Glyphs[i].Bounds.y = Y;
+		Glyphs[i].Bounds.w = Width;
+		Glyphs[i].Bounds.h = Surfaces[i] ? Surfaces[i]->h : 0;
+		Glyphs[i].Advance = Advance;
+		X += Width;
+	}
+
+	// Copy glyphs into atlas
+	SDL_Surface *Atlas = SDL_CreateRGBSurface(0, ATLAS_WIDTH, Y + Height, 32, 0x00FF0000, 0x0000FF00, 0x000000FF, 0xFF000000);
+	if(Atlas) {
+		SDL_FillRect(Atlas, nullptr, 0);
+		for(int i = 0; i < GLYPH_COUNT; i++) {
+			if(!Surfaces[i])
+				continue;
+
+			SDL_SetSurfaceBlendMode(Surfaces[i], SDL_BLENDMODE_NONE);
+			SDL_BlitSurface(Surfaces[i], nullptr, Atlas, &Glyphs[i].Bounds);
+		}
+
+		Texture = SDL_CreateTextureFromSurface(Renderer, Atlas);
+		if(Texture)
+			SDL_SetTextureBlendMode(Texture, SDL_BLENDMODE_BLEND);
+		SDL_FreeSurface(Atlas);
+	}
+
+	for(int i = 0; i < GLYPH_COUNT; i++)
+		SDL_FreeSurface(Surfaces[i]);
+
+	return Texture != nullptr;
+}
+
+// Draw a line of text as quads from the atlas
+void _Font::DrawText(const char *Text, int X, int Y, const SDL_Color &Color) const {
+	SDL_SetTextureColorMod(Texture, Color.r, Color.g, Color.b);
+	SDL_SetTextureAlphaMod(Texture, Color.a);
+
+	SDL_Rect Bounds;
+	Bounds.x = X;
+	Bounds.y = Y;
+	for(const char *Character = Text; *Character; Character++) {
+		int Index = (unsigned char)*Character - GLYPH_FIRST;
+		if(Index < 0 || Index >= GLYPH_COUNT)
+			continue;
+
+		const _Glyph &Glyph = Glyphs[Index];
+		Bounds.w = Glyph.Bounds.w;
+		Bounds.h = Glyph.Bounds.h;
+		if(Bounds.w)
+			SDL_RenderCopy(Renderer, Texture, &Glyph.Bounds, &Bounds);
+		Bounds.x += Glyph.Advance;
+	}
+}
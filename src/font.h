@@ -0,0 +1,56 @@
+/******************************************************************************
+* openflap
+* Copyright (C) 2014  Alan Witkowski
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*******************************************************************************/
+#pragma once
+
+// Libraries
+#include <SDL.h>
+#include <SDL_ttf.h>
+
+// Text renderer that draws glyphs from a texture atlas built once at startup
+class _Font {
+
+	public:
+
+		_Font() : Renderer(nullptr), Texture(nullptr), Height(0) { }
+		~_Font();
+
+		bool Load(SDL_Renderer *Renderer, TTF_Font *Font);
+		void DrawText(const char *Text, int X, int Y, const SDL_Color &Color) const;
+
+		int GetHeight() const { return Height; }
+
+	private:
+
+		// First and last characters in the atlas
+		static const int GLYPH_FIRST = 32;
+		static const int GLYPH_LAST = 126;
+		static const int GLYPH_COUNT = GLYPH_LAST - GLYPH_FIRST + 1;
+		static const int ATLAS_WIDTH = 512;
+
+		// Location of a glyph in the atlas
+		struct _Glyph {
+			SDL_Rect Bounds;
+			int Advance;
+		};
+
+		SDL_Renderer *Renderer;
+		SDL_Texture *Texture;
+		_Glyph Glyphs[GLYPH_COUNT];
+		int Height;
+
+};
@@ -0,0 +1,115 @@
+/******************************************************************************
+* openflap
+* Copyright (C) 2014  Alan Witkowski
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*******************************************************************************/
+#include <framestats.h>
+#include <fstream>
+
+// Reset counts
+void _Histogram::Clear() {
+	for(int i = 0; i < BUCKET_COUNT; i++)
+		Buckets[i] = 0;
+
+	Count = 0;
+	Total = 0;
+	Max = 0;
+}
+
+// Record a value
+void _Histogram::Add(uint32_t Value) {
+	Buckets[GetBucket(Value)]++;
+	Count++;
+	Total += Value;
+	if(Value > Max)
+		Max = Value;
+}
+
+// Get the smallest bucket end that covers the given percentage of values
+uint32_t _Histogram::GetPercentile(double Percentile) const {
+	if(!Count)
+		return 0;
+
+	uint64_t Rank = (uint64_t)(Percentile / 100.0 * Count + 0.5);
+	if(Rank < 1)
+		Rank = 1;
+
+	uint64_t Sum = 0;
+	for(int i = 0; i < BUCKET_COUNT; i++) {
+		Sum += Buckets[i];
+		if(Sum >= Rank) {
+			uint32_t End = GetBucketEnd(i);
+			return End < Max ? End : Max;
+		}
+	}
+
+	return Max;
+}
+
+// Small values get their own bucket, larger ones are split into eight per power of two
+int _Histogram::GetBucket(uint32_t Value) {
+	if(Value < LINEAR_COUNT)
+		return Value;
+
+	int Exponent = 31 - __builtin_clz(Value);
+	int Sub = (Value >> (Exponent - 3)) & (SUB_BUCKETS - 1);
+	int Bucket = LINEAR_COUNT + (Exponent - 4) * SUB_BUCKETS + Sub;
+
+	return Bucket < BUCKET_COUNT ? Bucket : BUCKET_COUNT - 1;
+}
+
+// Get the largest value that falls in a bucket
+uint32_t _Histogram::GetBucketEnd(int Bucket) {
+	if(Bucket < LINEAR_COUNT)
+		return Bucket;
+
+	int Exponent = (Bucket - LINEAR_COUNT) / SUB_BUCKETS + 4;
+	int Sub = (Bucket - LINEAR_COUNT) % SUB_BUCKETS;
+	uint64_t End = ((uint64_t)(SUB_BUCKETS + Sub + 1) << (Exponent - 3)) - 1;
+
+	return End > UINT32_MAX ? UINT32_MAX : (uint32_t)End;
+}
+
+// Record the duration of a phase in performance counter ticks
+void _FrameStats::Add(FramePhaseType Phase, uint64_t Ticks) {
+	uint64_t Microseconds = Ticks * 1000000 / Frequency;
+	Histograms[Phase].Add(Microseconds > UINT32_MAX ? UINT32_MAX : (uint32_t)Microseconds);
+}
+
+// Write a summary row for each phase
+bool _FrameStats::SaveCSV(const std::string &Path) const {
+	std::ofstream File(Path.c_str());
+	if(!File)
+		return false;
+
+	File << "phase,samples,mean_us,p50_us,p90_us,p99_us,max_us\n";
+	for(int i = 0; i < PHASE_COUNT; i++) {
+		const _Histogram &Histogram = Histograms[i];
+		File << GetPhaseName(i) << "," << Histogram.GetCount() << "," << (uint64_t)(Histogram.GetMean() + 0.5);
+		File << "," << Histogram.GetPercentile(50.0) << "," << Histogram.GetPercentile(90.0) << "," << Histogram.GetPercentile(99.0);
+		File << "," << Histogram.GetMax() << "\n";
+	}
+
+	return true;
+}
+
+// Get name of phase
+const char *_FrameStats::GetPhaseName(int Phase) {
+	static const char *Names[PHASE_COUNT] = { "events", "update", "render", "present", "delay", "frame" };
+	if(Phase < 0 || Phase >= PHASE_COUNT)
+		return "";
+
+	return Names[Phase];
+}
@@ -0,0 +1,86 @@
+/******************************************************************************
+* openflap
+* Copyright (C) 2014  Alan Witkowski
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*******************************************************************************/
+#pragma once
+
+// Libraries
+#include <stdint.h>
+#include <string>
+
+// Parts of a frame in the main loop
+enum FramePhaseType {
+	PHASE_EVENTS,
+	PHASE_UPDATE,
+	PHASE_RENDER,
+	PHASE_PRESENT,
+	PHASE_DELAY,
+	PHASE_FRAME,
+	PHASE_COUNT,
+};
+
+// Fixed size histogram of durations in microseconds, with about 12% resolution
+class _Histogram {
+
+	public:
+
+		static const int LINEAR_COUNT = 16;
+		static const int SUB_BUCKETS = 8;
+		static const int BUCKET_COUNT = 192;
+
+		_Histogram() { Clear(); }
+
+		void Clear();
+		void Add(uint32_t Value);
+
+		uint32_t GetPercentile(double Percentile) const;
+		uint32_t GetMax() const { return Max; }
+		uint64_t GetCount() const { return Count; }
+		double GetMean() const { return Count ? (double)Total / Count : 0.0; }
+
+	private:
+
+		static int GetBucket(uint32_t Value);
+		static uint32_t GetBucketEnd(int Bucket);
+
+		uint32_t Buckets[BUCKET_COUNT];
+		uint64_t Count;
+		uint64_t Total;
+		uint32_t Max;
+
+};
+
+// Time spent in each phase of the main loop
+class _FrameStats {
+
+	public:
+
+		_FrameStats() : Frequency(1) { }
+
+		void Init(uint64_t Frequency) { this->Frequency = Frequency; }
+		void Add(FramePhaseType Phase, uint64_t Ticks);
+		bool SaveCSV(const std::string &Path) const;
+
+		const _Histogram &GetHistogram(int Phase) const { return Histograms[Phase]; }
+
+		static const char *GetPhaseName(int Phase);
+
+	private:
+
+		uint64_t Frequency;
+		_Histogram Histograms[PHASE_COUNT];
+
+};
@@ -0,0 +1,456 @@
+/******************************************************************************
+* openflap
+* Copyright (C) 2014  Alan Witkowski
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*******************************************************************************/
+#include <game.h>
+#include <constants.h>
+#include <algorithm>
+#include <cmath>
+#include <type_traits>
+
+static_assert(std::is_trivially_copyable<_GameState>::value, "_GameState must be trivially copyable");
+
+// Constructor
+_GameState::_GameState() :
+	State(STATE_PLAY),
+	Death(DEATH_NONE),
+	Seed(0),
+	Ticks(0),
+	Time(0.0f),
+	SpawnTimer(0.0f),
+	DiedTimer(0.0f) {
+}
+
+// Constructor
+_Game::_Game(int ScreenWidth, int ScreenHeight) :
+	ScreenWidth(ScreenWidth),
+	ScreenHeight(ScreenHeight),
+	Integrator(INTEGRATOR_RK4),
+	TicksPerStep(1),
+	Events(0) {
+}
+
+// Destructor
+_Game::~_Game() {
+}
+
+// Initialize game state
+void _Game::Init(uint32_t Seed) {
+	this->Seed = Seed;
+	RandomGenerator.seed(Seed);
+	State = STATE_PLAY;
+	Death = DEATH_NONE;
+	Walls.Clear();
+	Backgrounds.Clear();
+	Player = _Player(_Physics(Vector2(PLAYER_X, 0), Vector2(0, 0), Vector2(0, GRAVITY)));
+	Player.Init();
+	Player.Physics.SetIntegrator(Integrator);
+	SpawnTimer = 0.0f;
+	DiedTimer = 0.0f;
+	Time = 0.0f;
+	Ticks = 0;
+
+	AddBackground(0, 0, ScreenHeight, -5);
+	AddBackground(0, ScreenWidth, ScreenHeight, -5);
+	AddBackground(1, 0, 200, -30);
+	AddBackground(1, ScreenWidth, 200, -30);
+	AddBackground(1, 0, 100, -50);
+	AddBackground(1, ScreenWidth, 100, -50);
+}
+
+// Copy the simulation state into a snapshot
+void _Game::Save(_GameState &Snapshot) const {
+	Snapshot = *this;
+}
+
+// Return to a saved snapshot
+void _Game::Restore(const _GameState &Snapshot) {
+	static_cast<_GameState &>(*this) = Snapshot;
+}
+
+// Advance the simulation by TicksPerStep fixed timesteps
+int _Game::Step(const _Input &Input) {
+	Events = 0;
+
+	// Handle input, moving the player up to the moment within the step that the jump was pressed
+	float JumpTime = 0.0f;
+	Vector2 LastPosition = Player.Physics.GetPosition();
+	if(Input.Jump && State == STATE_PLAY) {
+		JumpTime = Input.JumpOffset * (GAME_TIMESTEP / INPUT_SUBTICKS);
+		if(JumpTime > 0.0f)
+			Player.Update(JumpTime);
+		Player.Jump(JUMP_POWER);
+		Events |= EVENT_JUMP;
+	}
+
+	// Cover a coarse step with one update and a swept collision test when the path is a plain arc
+	if(TicksPerStep > 1 && JumpTime == 0.0f && CanSweep()) {
+		UpdateSwept();
+		return Events;
+	}
+
+	Update(GAME_TIMESTEP, JumpTime);
+	if(JumpTime > 0.0f)
+		Player.Physics.SetLastPosition(LastPosition);
+	Ticks++;
+
+	// Otherwise run the rest of a coarse step one tick at a time
+	for(int i = 1; i < TicksPerStep && State == STATE_PLAY; i++) {
+		Update(GAME_TIMESTEP, 0.0f);
+		Ticks++;
+	}
+
+	return Events;
+}
+
+// Update game, with the player already moved forward by PlayerTime
+void _Game::Update(float FrameTime, float PlayerTime) {
+	if(State == STATE_PLAY)
+		Time += FrameTime;
+
+	// Update player
+	Player.Update(FrameTime - PlayerTime);
+
+	// Update walls, which leave the screen in the order they were spawned
+	Walls.Update(FrameTime);
+	while(Walls.GetCount()) {
+		int Index = Walls.GetIndex(0);
+		if(Walls.X[Index] + Walls.Width[Index] >= 0)
+			break;
+
+		Walls.RemoveFront();
+	}
+
+	// Update backgrounds
+	Backgrounds.Update(FrameTime);
+	for(int i = 0; i < Backgrounds.GetCount(); i++) {
+		int Index = Backgrounds.GetIndex(i);
+		if(Backgrounds.X[Index] <= -ScreenWidth)
+			Backgrounds.X[Index] = Backgrounds.LastX[Index] = ScreenWidth;
+	}
+
+	if(State == STATE_PLAY) {
+
+		// Spawn new walls
+		SpawnTimer -= FrameTime;
+		if(SpawnTimer <= 0.0f) {
+			float Low = ScreenHeight/2 - SPAWN_RANGE;
+			float High = ScreenHeight/2 + SPAWN_RANGE;
+			float Y = (float)GetRandomReal(Low, High);
+			SpawnWall(Y);
+			SpawnTimer = SPAWNTIME;
+		}
+
+		// Check collisions
+		CheckCollision();
+	}
+	else
+		DiedTimer -= FrameTime;
+}
+
+// Check that the player follows a single arc over a coarse step, without being stopped by the ceiling
+bool _Game::CanSweep() const {
+	if(State != STATE_PLAY || Player.Physics.GetIntegrator() == INTEGRATOR_EULER)
+		return false;
+
+	float StepTime = GAME_TIMESTEP * TicksPerStep;
+	float Y = Player.Physics.GetPosition().Y;
+	float VelocityY = Player.Physics.GetVelocity().Y;
+	float AccelerationY = Player.Physics.GetAcceleration().Y;
+	float Top = std::min(Y, Y + VelocityY * StepTime + 0.5f * AccelerationY * StepTime * StepTime);
+	if(VelocityY < 0.0f && AccelerationY > 0.0f && -VelocityY < AccelerationY * StepTime)
+		Top = Y - VelocityY * VelocityY / (2.0f * AccelerationY);
+
+	return Top >= 0.0f;
+}
+
+// Advance TicksPerStep ticks with the same arithmetic as single ticks. The player moves with its integrator
+// every tick, but only walls that a swept test over the whole step says it can reach are tested, from the
+// tick it can first reach them, and everything else moves once the ticks are done.
+void _Game::UpdateSwept() {
+	float StepTime = GAME_TIMESTEP * TicksPerStep;
+	Vector2 Position = Player.Physics.GetPosition();
+	Vector2 Velocity = Player.Physics.GetVelocity();
+	Vector2 Acceleration = Player.Physics.GetAcceleration();
+	Vector2 End = Position + Velocity * StepTime + Acceleration * (0.5f * StepTime * StepTime);
+
+	// Sweep the arc's chord against each wall within reach in the wall's frame, widening the circle by
+	// the arc's sag and a little for rounding. Walls spawned during the step are added as they spawn, and
+	// no wall leaves the buffer until the ticks are done, so there are never more candidates than walls.
+	int Candidates[_SpriteBuffer::CAPACITY];
+	int FirstTicks[_SpriteBuffer::CAPACITY];
+	float CandidateX[_SpriteBuffer::CAPACITY];
+	int CandidateCount = 0;
+	float Radius = Player.Radius + 0.125f * std::abs(Acceleration.Y) * StepTime * StepTime + 0.01f;
+	for(int i = 0; i < Walls.GetCount(); i++) {
+		int Index = Walls.GetIndex(i);
+		float Left = Walls.X[Index];
+		float Shift = Walls.Velocity[Index] * StepTime;
+		if(Left + std::min(Shift, 0.0f) > Position.X + Radius || Left + Walls.Width[Index] + std::max(Shift, 0.0f) < Position.X - Radius)
+			continue;
+
+		float Top = Walls.Y[Index];
+		float Impact;
+		if(SweepWallCollision(Position, Vector2(End.X - Shift, End.Y), Radius, Left, Top, Left + Walls.Width[Index], Top + Walls.Height[Index], Impact)) {
+			Candidates[CandidateCount] = Index;
+			FirstTicks[CandidateCount] = (int)(Impact * TicksPerStep);
+			CandidateX[CandidateCount] = Left;
+			CandidateCount++;
+		}
+	}
+
+	// Run the ticks for the player, the timers and the walls within reach, stopping on the tick of death
+	int OldCount = Walls.GetCount();
+	int SpawnTicks[_SpriteBuffer::CAPACITY];
+	bool Fell = false;
+	bool HitWall = false;
+	int Tick;
+	for(Tick = 1; Tick <= TicksPerStep && !Fell && !HitWall; Tick++) {
+		Time += GAME_TIMESTEP;
+		Player.Update(GAME_TIMESTEP);
+		for(int i = 0; i < CandidateCount; i++)
+			CandidateX[i] += Walls.Velocity[Candidates[i]] * GAME_TIMESTEP;
+
+		SpawnTimer -= GAME_TIMESTEP;
+		if(SpawnTimer <= 0.0f) {
+			float Low = ScreenHeight/2 - SPAWN_RANGE;
+			float High = ScreenHeight/2 + SPAWN_RANGE;
+			float Y = (float)GetRandomReal(Low, High);
+			int Count = Walls.GetCount();
+			SpawnWall(Y);
+			SpawnTimer = SPAWNTIME;
+
+			for(int i = Count; i < Walls.GetCount(); i++) {
+				int Index = Walls.GetIndex(i);
+				SpawnTicks[i - OldCount] = Tick;
+				Candidates[CandidateCount] = Index;
+				FirstTicks[CandidateCount] = Tick;
+				CandidateX[CandidateCount] = Walls.X[Index];
+				CandidateCount++;
+			}
+		}
+
+		Fell = Player.Physics.GetPosition().Y > ScreenHeight + Player.Radius;
+		for(int i = 0; i < CandidateCount; i++) {
+			int Index = Candidates[i];
+			if(Tick >= FirstTicks[i] && CheckWallCollision(Player, CandidateX[i], Walls.Y[Index], CandidateX[i] + Walls.Width[Index], Walls.Y[Index] + Walls.Height[Index]))
+				HitWall = true;
+		}
+	}
+	int StepTicks = Tick - 1;
+	Ticks += StepTicks;
+
+	// Move walls one tick at a time for the ticks they were alive, then drop the ones that left the screen
+	for(int i = 0; i < Walls.GetCount(); i++) {
+		int Index = Walls.GetIndex(i);
+		int Moves = i < OldCount ? StepTicks : StepTicks - SpawnTicks[i - OldCount];
+		for(int Move = 0; Move < Moves; Move++) {
+			Walls.LastX[Index] = Walls.X[Index];
+			Walls.X[Index] += Walls.Velocity[Index] * GAME_TIMESTEP;
+		}
+	}
+	while(Walls.GetCount()) {
+		int Index = Walls.GetIndex(0);
+		if(Walls.X[Index] + Walls.Width[Index] >= 0)
+			break;
+
+		Walls.RemoveFront();
+	}
+
+	// Backgrounds restart from the right edge on the tick they leave the screen
+	for(int i = 0; i < Backgrounds.GetCount(); i++) {
+		int Index = Backgrounds.GetIndex(i);
+		for(int Move = 0; Move < StepTicks; Move++) {
+			Backgrounds.LastX[Index] = Backgrounds.X[Index];
+			Backgrounds.X[Index] += Backgrounds.Velocity[Index] * GAME_TIMESTEP;
+			if(Backgrounds.X[Index] <= -ScreenWidth)
+				Backgrounds.X[Index] = Backgrounds.LastX[Index] = ScreenWidth;
+		}
+	}
+
+	// Die in the same order as a single tick
+	if(Fell)
+		Died(DEATH_FALL);
+	if(HitWall)
+		Died(DEATH_WALL);
+}
+
+// Check collisions between player and world
+void _Game::CheckCollision() {
+	if(Player.Physics.GetPosition().Y > ScreenHeight + Player.Radius)
+		Died(DEATH_FALL);
+
+	for(int i = 0; i < Walls.GetCount(); i++) {
+		if(CheckWallCollision(Walls.GetIndex(i)))
+			Died(DEATH_WALL);
+	}
+}
+
+// Player has died
+void _Game::Died(DeathType Death) {
+	Walls.Stop();
+
+	State = STATE_DIED;
+	DiedTimer = DIED_WAIT_TIME;
+	this->Death = Death;
+	Events |= EVENT_DIED;
+}
+
+// Create wall objects above and below the gap
+void _Game::SpawnWall(float MidY) {
+	float StartY, EndY;
+	StartY = 0;
+	EndY = MidY - SPACING;
+	Walls.Add(ScreenWidth, StartY, (int)WALL_WIDTH, (int)(EndY - StartY), WALL_VELOCITY, 0);
+
+	StartY = MidY + SPACING;
+	EndY = ScreenHeight;
+	Walls.Add(ScreenWidth, StartY, (int)WALL_WIDTH, (int)(EndY - StartY), WALL_VELOCITY, 0);
+}
+
+// Create background layer
+void _Game::AddBackground(int Texture, float X, int Height, float Velocity) {
+	Backgrounds.Add(X, ScreenHeight - Height, ScreenWidth, Height, Velocity, Texture);
+}
+
+// Test collision between player and wall
+bool _Game::CheckWallCollision(int Index) const {
+	return CheckWallCollision(Player, Walls.X[Index], Walls.Y[Index], Walls.X[Index] + Walls.Width[Index], Walls.Y[Index] + Walls.Height[Index]);
+}
+
+// Test collision between box and circle
+bool _Game::CheckWallCollision(const _Player &Player, float Left, float Top, float Right, float Bottom) {
+	float AABB[4] = { Left, Top, Right, Bottom };
+
+	// Get closest point on AABB
+	float X = Player.Physics.GetPosition().X;
+	float Y = Player.Physics.GetPosition().Y;
+	if(X < AABB[0])
+		X = AABB[0];
+	if(Y < AABB[1])
+		Y = AABB[1];
+	if(X > AABB[2])
+		X = AABB[2];
+	if(Y > AABB[3])
+		Y = AABB[3];
+
+	// Test circle collision with point
+	float DistanceX = X - Player.Physics.GetPosition().X;
+	float DistanceY = Y - Player.Physics.GetPosition().Y;
+	float DistanceSquared = (DistanceX * DistanceX + DistanceY * DistanceY);
+	bool Hit = DistanceSquared < Player.Radius * Player.Radius;
+
+	return Hit;
+}
+
+// Get the earliest time in [0, 1] a point moving from Start by Delta enters a box
+static bool SweepBox(const Vector2 &Start, const Vector2 &Delta, float Left, float Top, float Right, float Bottom, float &Impact) {
+	float Enter = 0.0f;
+	float Exit = 1.0f;
+	float Minimum[2] = { Left, Top };
+	float Maximum[2] = { Right, Bottom };
+	for(int i = 0; i < 2; i++) {
+		if(Delta[i] == 0.0f) {
+			if(Start[i] < Minimum[i] || Start[i] > Maximum[i])
+				return false;
+			continue;
+		}
+
+		float Near = (Minimum[i] - Start[i]) / Delta[i];
+		float Far = (Maximum[i] - Start[i]) / Delta[i];
+		if(Near > Far)
+			std::swap(Near, Far);
+		Enter = std::max(Enter, Near);
+		Exit = std::min(Exit, Far);
+		if(Enter > Exit)
+			return false;
+	}
+
+	Impact = Enter;
+	return true;
+}
+
+// Get the earliest time in [0, 1] a point moving from Start by Delta comes within Radius of a corner
+static bool SweepCorner(const Vector2 &Start, const Vector2 &Delta, float X, float Y, float Radius, float &Impact) {
+	Vector2 Offset = Start - Vector2(X, Y);
+	float C = Offset * Offset - Radius * Radius;
+	if(C <= 0.0f) {
+		Impact = 0.0f;
+		return true;
+	}
+
+	float A = Delta * Delta;
+	float B = Offset * Delta;
+	float Discriminant = B * B - A * C;
+	if(A == 0.0f || B >= 0.0f || Discriminant < 0.0f)
+		return false;
+
+	Impact = (-B - std::sqrt(Discriminant)) / A;
+	return Impact <= 1.0f;
+}
+
+// Get the earliest fraction of the way from Start to End that a moving circle touches a box.
+// The box grown by the radius is two crossed rectangles and a circle at each corner.
+bool _Game::SweepWallCollision(const Vector2 &Start, const Vector2 &End, float Radius, float Left, float Top, float Right, float Bottom, float &Impact) {
+	if(std::min(Start.X, End.X) - Radius > Right || std::max(Start.X, End.X) + Radius < Left || std::min(Start.Y, End.Y) - Radius > Bottom || std::max(Start.Y, End.Y) + Radius < Top)
+		return false;
+
+	Vector2 Delta = End - Start;
+	bool Hit = false;
+	Impact = 1.0f;
+
+	float Enter;
+	if(SweepBox(Start, Delta, Left - Radius, Top, Right + Radius, Bottom, Enter) && Enter <= Impact) {
+		Impact = Enter;
+		Hit = true;
+	}
+	if(SweepBox(Start, Delta, Left, Top - Radius, Right, Bottom + Radius, Enter) && Enter <= Impact) {
+		Impact = Enter;
+		Hit = true;
+	}
+
+	float Corners[4][2] = { { Left, Top }, { Right, Top }, { Left, Bottom }, { Right, Bottom } };
+	for(int i = 0; i < 4; i++) {
+		if(SweepCorner(Start, Delta, Corners[i][0], Corners[i][1], Radius, Enter) && Enter <= Impact) {
+			Impact = Enter;
+			Hit = true;
+		}
+	}
+
+	return Hit;
+}
+
+// Get the position of the nearest wall gap that the player hasn't passed
+bool _Game::GetNextGap(float &GapX, float &GapY) const {
+	float PlayerLeft = Player.Physics.GetPosition().X - Player.Radius;
+	for(int i = 0; i + 1 < Walls.GetCount(); i += 2) {
+		int Top = Walls.GetIndex(i);
+		int Bottom = Walls.GetIndex(i + 1);
+		if(Walls.X[Top] + Walls.Width[Top] >= PlayerLeft) {
+			GapX = Walls.X[Top];
+			GapY = (Walls.Y[Top] + Walls.Height[Top] + Walls.Y[Bottom]) * 0.5f;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+// Return random double from Min to Max
+double _Game::GetRandomReal(double Min, double Max) {
+	std::uniform_real_distribution<double> Distribution(Min, Max);
+	return Distribution(RandomGenerator);
+}
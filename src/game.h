@@ -0,0 +1,108 @@
+/******************************************************************************
+* openflap
+* Copyright (C) 2014  Alan Witkowski
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*******************************************************************************/
+#pragma once
+
+// Libraries
+#include <player.h>
+#include <sprite.h>
+#include <stdint.h>
+#include <random>
+
+// Game states
+enum GameState {
+	STATE_PLAY,
+	STATE_DIED,
+};
+
+// Causes of death
+enum DeathType {
+	DEATH_NONE,
+	DEATH_FALL,
+	DEATH_WALL,
+	DEATH_COUNT,
+};
+
+// Events returned from a simulation step
+enum GameEventType {
+	EVENT_JUMP = 1 << 0,
+	EVENT_DIED = 1 << 1,
+};
+
+// Input for one simulation step
+struct _Input {
+	_Input() : Jump(false), JumpOffset(0) { }
+
+	bool Jump;
+	uint8_t JumpOffset;
+};
+
+// Everything that changes during a game, trivially copyable so a snapshot is a flat copy
+struct _GameState {
+	_GameState();
+
+	GameState State;
+	DeathType Death;
+	uint32_t Seed;
+	uint32_t Ticks;
+	float Time;
+	float SpawnTimer;
+	float DiedTimer;
+	_Player Player;
+	_SpriteBuffer Walls;
+	_SpriteBuffer Backgrounds;
+	std::mt19937 RandomGenerator;
+};
+
+// Headless game simulation
+class _Game : public _GameState {
+
+	public:
+
+		_Game(int ScreenWidth, int ScreenHeight);
+		~_Game();
+
+		void Init(uint32_t Seed);
+		int Step(const _Input &Input);
+
+		void Save(_GameState &Snapshot) const;
+		void Restore(const _GameState &Snapshot);
+
+		void SpawnWall(float MidY);
+		bool CheckWallCollision(int Index) const;
+		static bool CheckWallCollision(const _Player &Player, float Left, float Top, float Right, float Bottom);
+		static bool SweepWallCollision(const Vector2 &Start, const Vector2 &End, float Radius, float Left, float Top, float Right, float Bottom, float &Impact);
+		bool GetNextGap(float &GapX, float &GapY) const;
+
+		// Attributes
+		int ScreenWidth, ScreenHeight;
+		IntegratorType Integrator;
+		int TicksPerStep;
+
+	private:
+
+		void Update(float FrameTime, float PlayerTime);
+		bool CanSweep() const;
+		void UpdateSwept();
+		void CheckCollision();
+		void AddBackground(int Texture, float X, int Height, float Velocity);
+		void Died(DeathType Death);
+		double GetRandomReal(double Min, double Max);
+
+		int Events;
+
+};
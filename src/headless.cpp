@@ -0,0 +1,484 @@
+/******************************************************************************
+* openflap
+* Copyright (C) 2014  Alan Witkowski
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*******************************************************************************/
+#include <headless.h>
+#include <game.h>
+#include <population.h>
+#include <policy.h>
+#include <replay.h>
+#include <mappedfile.h>
+#include <workpool.h>
+#include <constants.h>
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <chrono>
+#include <memory>
+#include <vector>
+#include <mutex>
+#include <algorithm>
+#include <cstdlib>
+#include <dirent.h>
+
+// Results gathered by one worker
+struct _HeadlessStats {
+	_HeadlessStats() : Games(0), Ticks(0), TotalScore(0.0), BestScore(-1.0f), BestSeed(0) {
+		for(int i = 0; i < DEATH_COUNT; i++)
+			Deaths[i] = 0;
+	}
+
+	uint64_t Games;
+	uint64_t Ticks;
+	uint64_t Deaths[DEATH_COUNT];
+	double TotalScore;
+	float BestScore;
+	uint32_t BestSeed;
+};
+
+// Outcome of checking one replay file
+enum VerifyStatusType {
+	VERIFY_OK,
+	VERIFY_MISMATCH,
+	VERIFY_VERSION,
+	VERIFY_GEOMETRY,
+	VERIFY_INVALID,
+	VERIFY_COUNT,
+};
+
+// Result of checking one replay file
+struct _VerifyResult {
+	_VerifyResult() : Status(VERIFY_INVALID), Seed(0), ScreenWidth(0), ScreenHeight(0), ClaimedTicks(0), Ticks(0), ClaimedScore(0.0f), Score(0.0f) { }
+
+	VerifyStatusType Status;
+	uint32_t Seed;
+	uint32_t ScreenWidth, ScreenHeight;
+	uint32_t ClaimedTicks, Ticks;
+	float ClaimedScore, Score;
+};
+
+// Get name of death cause
+static const char *GetDeathName(DeathType Death) {
+	switch(Death) {
+		case DEATH_FALL:
+			return "fall";
+		case DEATH_WALL:
+			return "wall";
+		default:
+		break;
+	}
+
+	return "timeout";
+}
+
+// Parse seed range in the form A..B or A, where both start with a digit so strtoull can't skip spaces or take a sign
+bool ParseSeedRange(const std::string &Range, uint64_t &Start, uint64_t &End) {
+	if(Range.empty() || Range[0] < '0' || Range[0] > '9')
+		return false;
+
+	char *Last;
+	Start = strtoull(Range.c_str(), &Last, 10);
+
+	End = Start;
+	if(*Last == '\0')
+		return Start <= UINT32_MAX;
+
+	if(Last[0] != '.' || Last[1] != '.')
+		return false;
+
+	const char *Second = Last + 2;
+	if(Second[0] < '0' || Second[0] > '9')
+		return false;
+
+	End = strtoull(Second, &Last, 10);
+	if(*Last != '\0')
+		return false;
+
+	return Start <= End && End <= UINT32_MAX;
+}
+
+// Parse integrator name
+bool ParseIntegrator(const std::string &Name, IntegratorType &Integrator) {
+	if(Name == "rk4")
+		Integrator = INTEGRATOR_RK4;
+	else if(Name == "analytic")
+		Integrator = INTEGRATOR_ANALYTIC;
+	else if(Name == "euler")
+		Integrator = INTEGRATOR_EULER;
+	else
+		return false;
+
+	return true;
+}
+
+// Parse a tick rate in Hz that divides the game's fixed rate
+bool ParseTickRate(const std::string &Rate, int &TicksPerStep) {
+	char *Last;
+	long Value = strtol(Rate.c_str(), &Last, 10);
+	if(Last == Rate.c_str() || *Last != '\0' || Value <= 0 || Value > (long)GAME_FPS || (long)GAME_FPS % Value)
+		return false;
+
+	TicksPerStep = (int)((long)GAME_FPS / Value);
+	return true;
+}
+
+// Simulate a replay file as fast as possible and compare with its recorded result
+int RunReplay(const std::string &Path) {
+	_Replay Replay;
+	if(!Replay.Load(Path)) {
+		std::cout << "Cannot load replay: " << Path << std::endl;
+		return 1;
+	}
+
+	if(Replay.Version != GAME_VERSION) {
+		std::cout << "Replay is from version " << Replay.Version << ", expected " << GAME_VERSION << std::endl;
+		return 1;
+	}
+
+	if(!Replay.HasDefaultGeometry()) {
+		std::cout << "Replay is for screen size " << Replay.ScreenWidth << "x" << Replay.ScreenHeight << ", expected " << DEFAULT_SCREEN_WIDTH << "x" << DEFAULT_SCREEN_HEIGHT << std::endl;
+		return 1;
+	}
+
+	_Game Game(DEFAULT_SCREEN_WIDTH, DEFAULT_SCREEN_HEIGHT);
+	std::chrono::steady_clock::time_point StartTime = std::chrono::steady_clock::now();
+	bool Verified = Replay.Verify(Game);
+	double Elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - StartTime).count();
+
+	std::cout << std::fixed << std::setprecision(2);
+	std::cout << "seed=" << Replay.Seed << " score=" << Game.Time << " ticks=" << Game.Ticks;
+	std::cout << " claimed_score=" << Replay.Score << " claimed_ticks=" << Replay.Ticks;
+	std::cout << " result=" << (Verified ? "verified" : "mismatch") << std::setprecision(3) << " elapsed=" << Elapsed * 1000.0 << "ms" << std::endl;
+
+	return Verified ? 0 : 2;
+}
+
+// Re-simulate every replay in a directory across all cores and report mismatches
+int RunVerifyDirectory(const std::string &Path, const _HeadlessOptions &Options) {
+	const char *StatusNames[VERIFY_COUNT] = { "verified", "mismatch", "wrong_version", "wrong_geometry", "invalid" };
+
+	// Get sorted list of files
+	DIR *Directory = opendir(Path.c_str());
+	if(!Directory) {
+		std::cout << "Cannot open directory: " << Path << std::endl;
+		return 1;
+	}
+
+	std::vector<std::string> Files;
+	while(struct dirent *Entry = readdir(Directory)) {
+		if(Entry->d_name[0] != '.')
+			Files.push_back(Entry->d_name);
+	}
+	closedir(Directory);
+	std::sort(Files.begin(), Files.end());
+
+	std::string Prefix = Path;
+	if(!Prefix.empty() && Prefix.back() != '/')
+		Prefix += '/';
+
+	// Give each worker its own game
+	_WorkPool Pool(Options.Threads > 0 ? Options.Threads : _WorkPool::GetDefaultThreadCount());
+	std::vector<std::unique_ptr<_Game> > Games;
+	for(int i = 0; i < Pool.GetThreadCount(); i++)
+		Games.push_back(std::unique_ptr<_Game>(new _Game(DEFAULT_SCREEN_WIDTH, DEFAULT_SCREEN_HEIGHT)));
+
+	std::vector<_VerifyResult> Results(Files.size());
+	std::chrono::steady_clock::time_point StartTime = std::chrono::steady_clock::now();
+	Pool.Run(0, Files.size(), 16, [&](int Worker, uint64_t Begin, uint64_t End) {
+		_Game &Game = *Games[Worker];
+		_Replay Replay;
+		_MappedFile File;
+		for(uint64_t i = Begin; i < End; i++) {
+			_VerifyResult &Result = Results[i];
+			if(!File.Open(Prefix + Files[i]) || !Replay.Decode(File.GetData(), File.GetSize()))
+				continue;
+			File.Close();
+
+			Result.Seed = Replay.Seed;
+			Result.ScreenWidth = Replay.ScreenWidth;
+			Result.ScreenHeight = Replay.ScreenHeight;
+			Result.ClaimedTicks = Replay.Ticks;
+			Result.ClaimedScore = Replay.Score;
+			if(Replay.Version != GAME_VERSION) {
+				Result.Status = VERIFY_VERSION;
+				continue;
+			}
+
+			if(!Replay.HasDefaultGeometry()) {
+				Result.Status = VERIFY_GEOMETRY;
+				continue;
+			}
+
+			bool Verified = Replay.Verify(Game);
+			Result.Ticks = Game.Ticks;
+			Result.Score = Game.Time;
+			Result.Status = Verified ? VERIFY_OK : VERIFY_MISMATCH;
+		}
+	});
+	double Elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - StartTime).count();
+
+	// Print report
+	uint64_t Counts[VERIFY_COUNT] = { 0 };
+	uint64_t TotalTicks = 0;
+	std::cout << std::fixed << std::setprecision(2);
+	for(size_t i = 0; i < Results.size(); i++) {
+		const _VerifyResult &Result = Results[i];
+		Counts[Result.Status]++;
+		TotalTicks += Result.Ticks;
+		if(Options.Quiet && Result.Status == VERIFY_OK)
+			continue;
+
+		std::cout << "file=" << Files[i] << " status=" << StatusNames[Result.Status];
+		if(Result.Status != VERIFY_INVALID) {
+			std::cout << " seed=" << Result.Seed << " width=" << Result.ScreenWidth << " height=" << Result.ScreenHeight;
+			std::cout << " claimed_score=" << Result.ClaimedScore << " claimed_ticks=" << Result.ClaimedTicks;
+			if(Result.Status == VERIFY_OK || Result.Status == VERIFY_MISMATCH)
+				std::cout << " score=" << Result.Score << " ticks=" << Result.Ticks;
+		}
+		std::cout << "\n";
+	}
+
+	std::cout << "files=" << Results.size();
+	for(int i = 0; i < VERIFY_COUNT; i++)
+		std::cout << " " << StatusNames[i] << "=" << Counts[i];
+	std::cout << " threads=" << Pool.GetThreadCount() << std::setprecision(3) << " elapsed=" << Elapsed << "s";
+	if(Elapsed > 0.0) {
+		std::cout << std::setprecision(0);
+		std::cout << " replays/sec=" << Results.size() / Elapsed;
+		std::cout << " ticks/sec=" << TotalTicks / Elapsed;
+	}
+	std::cout << std::endl;
+
+	return Counts[VERIFY_OK] == Results.size() ? 0 : 2;
+}
+
+// Run a range of seeds without graphics, audio or fonts
+int RunHeadless(const _HeadlessOptions &Options) {
+	_WorkPool Pool(Options.Threads > 0 ? Options.Threads : _WorkPool::GetDefaultThreadCount());
+
+	// Give each worker its own game and policy
+	std::vector<std::unique_ptr<_Game> > Games;
+	std::vector<std::unique_ptr<_Policy> > Policies;
+	std::vector<_HeadlessStats> Stats(Pool.GetThreadCount());
+	for(int i = 0; i < Pool.GetThreadCount(); i++) {
+		Games.push_back(std::unique_ptr<_Game>(new _Game(DEFAULT_SCREEN_WIDTH, DEFAULT_SCREEN_HEIGHT)));
+		Games.back()->Integrator = Options.Integrator;
+		Games.back()->TicksPerStep = Options.TicksPerStep;
+		Policies.push_back(std::unique_ptr<_Policy>(CreatePolicy(Options.Policy)));
+		if(!Policies.back()) {
+			std::cout << "Unknown policy: " << Options.Policy << std::endl;
+			return 1;
+		}
+	}
+
+	std::mutex OutputMutex;
+	std::chrono::steady_clock::time_point StartTime = std::chrono::steady_clock::now();
+	Pool.Run(Options.SeedStart, Options.SeedEnd + 1, 64, [&](int Worker, uint64_t Begin, uint64_t End) {
+		_Game &Game = *Games[Worker];
+		_Policy &Policy = *Policies[Worker];
+		_HeadlessStats &Stat = Stats[Worker];
+
+		std::ostringstream Buffer;
+		Buffer << std::fixed << std::setprecision(2);
+		for(uint64_t Seed = Begin; Seed < End; Seed++) {
+
+			// Play game until death or tick limit
+			Game.Init((uint32_t)Seed);
+			Policy.Reset((uint32_t)Seed);
+			while(Game.State == STATE_PLAY && Game.Ticks < Options.MaxTicks) {
+				_Input Input;
+				Input.Jump = Policy.Jump(Game);
+				Game.Step(Input);
+			}
+
+			if(!Options.Quiet)
+				Buffer << "seed=" << Seed << " score=" << Game.Time << " ticks=" << Game.Ticks << " death=" << GetDeathName(Game.Death) << "\n";
+
+			Stat.Games++;
+			Stat.Ticks += Game.Ticks;
+			Stat.Deaths[Game.Death]++;
+			Stat.TotalScore += Game.Time;
+			if(Game.Time > Stat.BestScore) {
+				Stat.BestScore = Game.Time;
+				Stat.BestSeed = (uint32_t)Seed;
+			}
+		}
+
+		if(!Options.Quiet) {
+			std::lock_guard<std::mutex> Lock(OutputMutex);
+			std::cout << Buffer.str();
+		}
+	});
+	double Elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - StartTime).count();
+
+	// Combine worker results
+	_HeadlessStats Total;
+	for(size_t i = 0; i < Stats.size(); i++) {
+		Total.Games += Stats[i].Games;
+		Total.Ticks += Stats[i].Ticks;
+		Total.TotalScore += Stats[i].TotalScore;
+		for(int j = 0; j < DEATH_COUNT; j++)
+			Total.Deaths[j] += Stats[i].Deaths[j];
+		if(Stats[i].BestScore > Total.BestScore || (Stats[i].BestScore == Total.BestScore && Stats[i].BestSeed < Total.BestSeed)) {
+			Total.BestScore = Stats[i].BestScore;
+			Total.BestSeed = Stats[i].BestSeed;
+		}
+	}
+
+	// Print summary
+	std::cout << std::fixed << std::setprecision(2);
+	if(Total.Games) {
+		std::cout << "average=" << Total.TotalScore / Total.Games << " best=" << Total.BestScore << " best_seed=" << Total.BestSeed;
+		std::cout << " fall=" << Total.Deaths[DEATH_FALL] << " wall=" << Total.Deaths[DEATH_WALL] << " timeout=" << Total.Deaths[DEATH_NONE] << "\n";
+	}
+
+	// Print throughput
+	std::cout << "games=" << Total.Games << " ticks=" << Total.Ticks << " threads=" << Pool.GetThreadCount() << " elapsed=" << std::setprecision(3) << Elapsed << "s";
+	if(Elapsed > 0.0) {
+		std::cout << std::setprecision(0);
+		std::cout << " games/sec=" << Total.Games / Elapsed;
+		std::cout << " ticks/sec=" << Total.Ticks / Elapsed;
+	}
+	std::cout << std::endl;
+
+	// Print planner throughput
+	uint64_t Plans = 0, Nodes = 0;
+	double PlanTime = 0.0;
+	for(size_t i = 0; i < Policies.size(); i++) {
+		const _PlannerPolicy *PlannerPolicy = dynamic_cast<const _PlannerPolicy *>(Policies[i].get());
+		if(PlannerPolicy) {
+			Plans += PlannerPolicy->Planner.Plans;
+			Nodes += PlannerPolicy->Planner.Nodes;
+			PlanTime += PlannerPolicy->Planner.Time;
+		}
+	}
+	if(Plans && PlanTime > 0.0) {
+		std::cout << std::setprecision(0) << "plans=" << Plans << " nodes=" << Nodes << " nodes/ms=" << Nodes / (PlanTime * 1000.0);
+		std::cout << std::setprecision(3) << " ms/plan=" << PlanTime * 1000.0 / Plans << std::endl;
+	}
+
+	return 0;
+}
+
+// Fly a population through each seed's walls, giving player i the follow rule with its own margin above the gap's bottom
+int RunPopulation(const _HeadlessOptions &Options) {
+	_WorkPool Pool(Options.Threads > 0 ? Options.Threads : _WorkPool::GetDefaultThreadCount());
+
+	// Spread the margins evenly
+	int Count = Options.Population;
+	std::vector<float> Margins(Count);
+	for(int i = 0; i < Count; i++)
+		Margins[i] = POPULATION_MAX_MARGIN * i / Count;
+
+	// Give each worker its own population and a total score for each player
+	std::vector<std::unique_ptr<_Population> > Populations;
+	std::vector<std::vector<double> > Totals(Pool.GetThreadCount(), std::vector<double>(Count, 0.0));
+	std::vector<_HeadlessStats> Stats(Pool.GetThreadCount());
+	for(int i = 0; i < Pool.GetThreadCount(); i++)
+		Populations.push_back(std::unique_ptr<_Population>(new _Population(Count, DEFAULT_SCREEN_WIDTH, DEFAULT_SCREEN_HEIGHT)));
+
+	std::mutex OutputMutex;
+	std::chrono::steady_clock::time_point StartTime = std::chrono::steady_clock::now();
+	Pool.Run(Options.SeedStart, Options.SeedEnd + 1, 1, [&](int Worker, uint64_t Begin, uint64_t End) {
+		_Population &Population = *Populations[Worker];
+		std::vector<double> &Total = Totals[Worker];
+		_HeadlessStats &Stat = Stats[Worker];
+		std::vector<uint8_t> Jumps(Count);
+
+		std::ostringstream Buffer;
+		Buffer << std::fixed << std::setprecision(2);
+		for(uint64_t Seed = Begin; Seed < End; Seed++) {
+
+			// Play until everyone is dead or the tick limit
+			Population.Init((uint32_t)Seed);
+			while(Population.GetAlive() && Population.Ticks < Options.MaxTicks) {
+				Population.GetFollowJumps(Margins.data(), Jumps.data());
+				Population.Step(Jumps.data());
+			}
+
+			// Players still alive time out with the population's time
+			double SeedTotal = 0.0;
+			float SeedBest = -1.0f;
+			int Best = 0;
+			for(int i = 0; i < Count; i++) {
+				bool Living = Population.Living[i];
+				float Score = Living ? Population.Time : Population.FinalTime[i];
+				Total[i] += Score;
+				SeedTotal += Score;
+				Stat.Ticks += Living ? Population.Ticks : Population.FinalTicks[i];
+				Stat.Deaths[Living ? (int)DEATH_NONE : Population.Death[i]]++;
+				if(Score > SeedBest) {
+					SeedBest = Score;
+					Best = i;
+				}
+			}
+			Stat.Games += Count;
+			Stat.TotalScore += SeedTotal;
+			if(SeedBest > Stat.BestScore) {
+				Stat.BestScore = SeedBest;
+				Stat.BestSeed = (uint32_t)Seed;
+			}
+
+			if(!Options.Quiet) {
+				Buffer << "seed=" << Seed << " average=" << SeedTotal / Count << " best=" << SeedBest;
+				Buffer << " best_margin=" << Margins[Best] << " survivors=" << Population.GetAlive() << "\n";
+			}
+		}
+
+		if(!Options.Quiet) {
+			std::lock_guard<std::mutex> Lock(OutputMutex);
+			std::cout << Buffer.str();
+		}
+	});
+	double Elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - StartTime).count();
+
+	// Combine worker results
+	_HeadlessStats Total;
+	std::vector<double> PlayerTotals(Count, 0.0);
+	for(size_t i = 0; i < Stats.size(); i++) {
+		Total.Games += Stats[i].Games;
+		Total.Ticks += Stats[i].Ticks;
+		Total.TotalScore += Stats[i].TotalScore;
+		for(int j = 0; j < DEATH_COUNT; j++)
+			Total.Deaths[j] += Stats[i].Deaths[j];
+		if(Stats[i].BestScore > Total.BestScore || (Stats[i].BestScore == Total.BestScore && Stats[i].BestSeed < Total.BestSeed)) {
+			Total.BestScore = Stats[i].BestScore;
+			Total.BestSeed = Stats[i].BestSeed;
+		}
+		for(int j = 0; j < Count; j++)
+			PlayerTotals[j] += Totals[i][j];
+	}
+	int BestPlayer = (int)(std::max_element(PlayerTotals.begin(), PlayerTotals.end()) - PlayerTotals.begin());
+	uint64_t Seeds = Options.SeedEnd - Options.SeedStart + 1;
+
+	// Print summary
+	std::cout << std::fixed << std::setprecision(2);
+	std::cout << "average=" << Total.TotalScore / Total.Games << " best=" << Total.BestScore << " best_seed=" << Total.BestSeed;
+	std::cout << " best_margin=" << Margins[BestPlayer] << " best_margin_average=" << PlayerTotals[BestPlayer] / Seeds;
+	std::cout << " fall=" << Total.Deaths[DEATH_FALL] << " wall=" << Total.Deaths[DEATH_WALL] << " timeout=" << Total.Deaths[DEATH_NONE] << "\n";
+
+	// Print throughput
+	std::cout << "seeds=" << Seeds << " players=" << Count << " games=" << Total.Games << " ticks=" << Total.Ticks << " threads=" << Pool.GetThreadCount();
+	std::cout << " elapsed=" << std::setprecision(3) << Elapsed << "s";
+	if(Elapsed > 0.0) {
+		std::cout << std::setprecision(0);
+		std::cout << " games/sec=" << Total.Games / Elapsed;
+		std::cout << " ticks/sec=" << Total.Ticks / Elapsed;
+	}
+	std::cout << std::endl;
+
+	return 0;
+}
@@ -0,0 +1,45 @@
+/******************************************************************************
+* openflap
+* Copyright (C) 2014  Alan Witkowski
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*******************************************************************************/
+#pragma once
+
+// Libraries
+#include <stdint.h>
+#include <string>
+#include <physics.h>
+
+// Options for running games without a window
+struct _HeadlessOptions {
+	_HeadlessOptions() : SeedStart(0), SeedEnd(0), Policy("follow"), MaxTicks(360000), Integrator(INTEGRATOR_RK4), TicksPerStep(1), Threads(0), Population(0), Quiet(false) { }
+
+	uint64_t SeedStart, SeedEnd;
+	std::string Policy;
+	uint32_t MaxTicks;
+	IntegratorType Integrator;
+	int TicksPerStep;
+	int Threads;
+	int Population;
+	bool Quiet;
+};
+
+bool ParseSeedRange(const std::string &Range, uint64_t &Start, uint64_t &End);
+bool ParseIntegrator(const std::string &Name, IntegratorType &Integrator);
+bool ParseTickRate(const std::string &Rate, int &TicksPerStep);
+int RunHeadless(const _HeadlessOptions &Options);
+int RunPopulation(const _HeadlessOptions &Options);
+int RunReplay(const std::string &Path);
+int RunVerifyDirectory(const std::string &Path, const _HeadlessOptions &Options);
@@ -16,112 +16,249 @@
 * along with this program.  If not, see <http://www.gnu.org/licenses/>.
 *******************************************************************************/
 #include <SDL.h>
-#include <SDL_image.h>
 #include <SDL_ttf.h>
-#include <SDL_mixer.h>
+#include <SDL_image.h>
 #include <iostream>
-#include <sstream>
-#include <list>
-#include <vector2.h>
-#include <physics.h>
-#include <player.h>
-#include <sprite.h>
+#include <game.h>
+#include <render.h>
+#include <assets.h>
+#include <audio.h>
+#include <framestats.h>
+#include <trace.h>
+#include <capture.h>
+#include <pacer.h>
+#include <headless.h>
+#include <replay.h>
+#include <serve.h>
+#include <policy.h>
+#include <population.h>
 #include <config.h>
 #include <constants.h>
 #include <version.h>
+#include <algorithm>
+#include <cstdlib>
 #include <ctime>
 #include <random>
-
-enum GameState {
-	STATE_PLAY,
-	STATE_DIED,
-};
+#include <vector>
 
 void InitGame();
 void Died();
-void SpawnWall(float MidY);
-void CheckCollision();
-void Update(float FrameTime);
-void Render(float Blend);
-void DeleteObjects();
-void DrawText(const std::string &Text, int X, int Y, const SDL_Color &Color);
-bool CheckWallCollision(_Sprite *Wall);
+Uint64 EndPhase(FramePhaseType Phase, Uint64 StartTime);
+bool TakeJump(std::vector<double> &JumpTimes, double StepStart, double StepLength, uint8_t &Offset);
 void GetNewSeed(bool Print=false);
+bool ParseSeed(const std::string &Token, uint32_t &Value);
+void PrintUsage();
 int GetRandomInt(int Min, int Max);
-double GetRandomReal(double Min, double Max);
-
-const SDL_Color ColorWhite = { 255, 255, 255, 255 };
-const SDL_Color ColorRed = { 255, 0, 0, 255 };
 
 static std::string Version = GAME_VERSION;
-static GameState State;
 static float HighScore = 0.0f;
-static float Time;
-static float SpawnTimer;
-static float DiedTimer = 0.0f;
 static std::mt19937 RandomGenerator;
 static bool StaticSeed = false;
 static uint32_t Seed = 0;
-static _Player *Player = nullptr;
+static _Game *Game = nullptr;
+static _Replay Replay;
+static bool ReplayMode = false;
+static size_t ReplayCursor = 0;
+static _PlannerPolicy *Autopilot = nullptr;
+static _Population *Ghosts = nullptr;
+static std::vector<float> GhostMargins;
+static std::vector<uint8_t> GhostJumps;
 static SDL_Renderer *Renderer = nullptr;
-static SDL_Texture *Texture = nullptr;
-static SDL_Texture *WallTexture = nullptr;
-static SDL_Texture *TextTexture = nullptr;
-static SDL_Texture *BackTexture[4] = { nullptr, nullptr, nullptr, nullptr };
-static TTF_Font *Font = nullptr;
+static _Render *Render = nullptr;
+static _Assets Assets;
+static _Audio Audio;
+static _FrameStats FrameStats;
+static bool ShowFrameStats = false;
+static _Trace Trace;
+static _Capture Capture;
+static SDL_Texture *CaptureTexture = nullptr;
 static SDL_Joystick *Joystick = nullptr;
-static Mix_Chunk *DieSound = nullptr;
-static Mix_Chunk *JumpSound = nullptr;
-static Mix_Music *Music = nullptr;
 static std::string Songs[2] = { "audio/song_crunch.ogg", "audio/song_jazztown.ogg" };
-static std::list<_Sprite *> Walls;
-static std::list<_Sprite *> Backgrounds;
-typedef std::list<_Sprite *>::iterator SpriteIteratorType;
 
 int main(int ArgumentCount, char **Arguments) {
+	Uint64 StartupTime = SDL_GetPerformanceCounter();
 
 	// Get version;
 	if(GAME_BUILD)
 		Version += "r" + std::to_string(GAME_BUILD);
 
-	// Init config system
-	Config.Init("settings.cfg");
-
-	// Init SDL
-	if(SDL_Init(SDL_INIT_EVERYTHING) == -1) {
-		std::cout << SDL_GetError() << std::endl;
-		return 1;
+	// Parse arguments
+	bool Headless = false;
+	bool FastForward = false;
+	std::string ReplayPath;
+	std::string VerifyPath;
+	std::string ServeName;
+	int ServeEnvs = SERVE_DEFAULT_ENVS;
+	int GhostCount = 0;
+	std::string TracePath;
+	std::string CapturePath;
+	_HeadlessOptions HeadlessOptions;
+	for(int i = 1; i < ArgumentCount; i++) {
+		std::string Token = Arguments[i];
+		if(Token == "--headless") {
+			Headless = true;
+		}
+		else if(Token == "--seeds" && i+1 < ArgumentCount) {
+			if(!ParseSeedRange(Arguments[++i], HeadlessOptions.SeedStart, HeadlessOptions.SeedEnd)) {
+				std::cout << "Invalid seed range: " << Arguments[i] << std::endl;
+				return 1;
+			}
+		}
+		else if(Token == "--policy" && i+1 < ArgumentCount) {
+			HeadlessOptions.Policy = Arguments[++i];
+		}
+		else if(Token == "--max-ticks" && i+1 < ArgumentCount) {
+			HeadlessOptions.MaxTicks = (uint32_t)atoi(Arguments[++i]);
+		}
+		else if(Token == "--integrator" && i+1 < ArgumentCount) {
+			if(!ParseIntegrator(Arguments[++i], HeadlessOptions.Integrator)) {
+				std::cout << "Invalid integrator: " << Arguments[i] << std::endl;
+				return 1;
+			}
+		}
+		else if(Token == "--tick-rate" && i+1 < ArgumentCount) {
+			if(!ParseTickRate(Arguments[++i], HeadlessOptions.TicksPerStep)) {
+				std::cout << "Invalid tick rate: " << Arguments[i] << std::endl;
+				return 1;
+			}
+		}
+		else if(Token == "--threads" && i+1 < ArgumentCount) {
+			HeadlessOptions.Threads = atoi(Arguments[++i]);
+		}
+		else if(Token == "--quiet") {
+			HeadlessOptions.Quiet = true;
+		}
+		else if(Token == "--replay" && i+1 < ArgumentCount) {
+			ReplayPath = Arguments[++i];
+		}
+		else if(Token == "--serve" && i+1 < ArgumentCount) {
+			ServeName = Arguments[++i];
+		}
+		else if(Token == "--envs" && i+1 < ArgumentCount) {
+			ServeEnvs = atoi(Arguments[++i]);
+			if(ServeEnvs <= 0) {
+				std::cout << "Invalid environment count: " << Arguments[i] << std::endl;
+				return 1;
+			}
+		}
+		else if(Token == "--population" && i+1 < ArgumentCount) {
+			HeadlessOptions.Population = atoi(Arguments[++i]);
+			if(HeadlessOptions.Population <= 0) {
+				std::cout << "Invalid population: " << Arguments[i] << std::endl;
+				return 1;
+			}
+		}
+		else if(Token == "--ghosts" && i+1 < ArgumentCount) {
+			GhostCount = atoi(Arguments[++i]);
+			if(GhostCount <= 0) {
+				std::cout << "Invalid ghost count: " << Arguments[i] << std::endl;
+				return 1;
+			}
+		}
+		else if(Token == "--verify-dir" && i+1 < ArgumentCount) {
+			VerifyPath = Arguments[++i];
+		}
+		else if(Token == "--fast") {
+			FastForward = true;
+		}
+		else if(Token == "--autopilot") {
+			Autopilot = new _PlannerPolicy(PLANNER_BUDGET);
+		}
+		else if(Token == "--trace" && i+1 < ArgumentCount) {
+			TracePath = Arguments[++i];
+		}
+		else if(Token == "--capture" && i+1 < ArgumentCount) {
+			CapturePath = Arguments[++i];
+		}
+		else if(ParseSeed(Token, Seed)) {
+			StaticSeed = true;
+		}
+		else {
+			std::cout << "Unknown argument: " << Token << std::endl;
+			PrintUsage();
+			return 1;
+		}
 	}
 
-	// Get seed from arguments
-	if(ArgumentCount == 2) {
-		Seed = (uint32_t)atoi(Arguments[1]);
-		StaticSeed = true;
+	// Run simulations without a window
+	if(Headless && HeadlessOptions.Population)
+		return RunPopulation(HeadlessOptions);
+	if(Headless)
+		return RunHeadless(HeadlessOptions);
+
+	// Step games for another process through shared memory
+	if(!ServeName.empty())
+		return RunServe(ServeName, ServeEnvs, HeadlessOptions.Quiet);
+
+	// Verify replays without rendering
+	if(!ReplayPath.empty() && FastForward)
+		return RunReplay(ReplayPath);
+	if(!VerifyPath.empty())
+		return RunVerifyDirectory(VerifyPath, HeadlessOptions);
+
+	// Start tracing
+	if(!TracePath.empty() && !Trace.Open(TracePath)) {
+		std::cout << "Cannot open trace file: " << TracePath << std::endl;
+		return 1;
 	}
 
-	// Set seed
-	GetNewSeed();
+	// Init config system
+	Config.Init("settings.cfg");
 
-	// Init audio
-	if(Config.AudioEnabled) {
+	// Create simulation
+	Game = new _Game(Config.ScreenWidth, Config.ScreenHeight);
 
-		if(Mix_OpenAudio(44100, MIX_DEFAULT_FORMAT, 2, 1024) < 0) {
-			std::cout << Mix_GetError() << std::endl;
+	// Load replay to watch
+	if(!ReplayPath.empty()) {
+		if(!Replay.Load(ReplayPath)) {
+			std::cout << "Cannot load replay: " << ReplayPath << std::endl;
+			return 1;
+		}
+		if(Replay.Version != GAME_VERSION) {
+			std::cout << "Replay is from version " << Replay.Version << ", expected " << GAME_VERSION << std::endl;
 			return 1;
 		}
 
-		int MixFlags = MIX_INIT_OGG;
-		int MixInit = Mix_Init(MixFlags);
-		if((MixInit & MixFlags) != MixFlags) {
-			std::cout << Mix_GetError() << std::endl;
+		if(!Replay.HasDefaultGeometry()) {
+			std::cout << "Replay is for screen size " << Replay.ScreenWidth << "x" << Replay.ScreenHeight << ", expected " << DEFAULT_SCREEN_WIDTH << "x" << DEFAULT_SCREEN_HEIGHT << std::endl;
 			return 1;
 		}
 
-		JumpSound = Mix_LoadWAV("audio/swoop.ogg");
-		DieSound = Mix_LoadWAV("audio/pop.ogg");
-		Music = Mix_LoadMUS(Songs[GetRandomInt(0, 1)].c_str());
-		Mix_Volume(-1, (int)(Config.SoundVolume * MIX_MAX_VOLUME));
+		ReplayMode = true;
+		StaticSeed = true;
+		Seed = Replay.Seed;
+		Game->ScreenWidth = DEFAULT_SCREEN_WIDTH;
+		Game->ScreenHeight = DEFAULT_SCREEN_HEIGHT;
+	}
+
+	// Create ghosts that follow the gaps with margins spread between them
+	if(GhostCount) {
+		Ghosts = new _Population(GhostCount, Game->ScreenWidth, Game->ScreenHeight);
+		GhostJumps.resize(GhostCount);
+		for(int i = 0; i < GhostCount; i++)
+			GhostMargins.push_back(POPULATION_MAX_MARGIN * i / GhostCount);
+	}
+
+	// Init SDL, leaving the audio device to the audio thread
+	if(SDL_Init(SDL_INIT_EVERYTHING & ~SDL_INIT_AUDIO) == -1) {
+		std::cout << SDL_GetError() << std::endl;
+		return 1;
+	}
+
+	// Set seed
+	GetNewSeed();
+
+	// Start decoding images from the pack while the window is created
+	if((IMG_Init(IMG_INIT_PNG) & IMG_INIT_PNG) != IMG_INIT_PNG) {
+		std::cout << IMG_GetError() << std::endl;
+		return 1;
 	}
+	Assets.Open("openflap.pak", "");
+	Assets.StartDecode();
+
+	// Open audio and load music in the background, starting it when ready
+	if(Config.AudioEnabled)
+		Audio.Start(Assets, Songs[GetRandomInt(0, 1)], Config.SoundVolume, Config.MusicVolume);
 
 	// Init font system
 	if(TTF_Init() != 0) {
@@ -140,33 +277,52 @@ int main(int ArgumentCount, char **Arguments) {
 		return 1;
 	}
 
-	// Set up renderer
+	// Set up renderer, capturing with the software renderer so no GPU is needed
 	Flags = 0;
-	Flags |= SDL_RENDERER_ACCELERATED;
-	if(Config.Vsync)
-		Flags |= SDL_RENDERER_PRESENTVSYNC;
+	if(!CapturePath.empty())
+		Flags |= SDL_RENDERER_SOFTWARE | SDL_RENDERER_TARGETTEXTURE;
+	else {
+		Flags |= SDL_RENDERER_ACCELERATED;
+		if(Config.Vsync)
+			Flags |= SDL_RENDERER_PRESENTVSYNC;
+	}
 	Renderer = SDL_CreateRenderer(Window, -1, Flags);
 	if(Renderer == nullptr) {
 		std::cout << SDL_GetError() << std::endl;
 		return 1;
 	}
 
-	// Load fonts
-	Font = TTF_OpenFont("font/arimo_regular.ttf", 18);
-	if(Font == nullptr) {
-		std::cout << SDL_GetError() << std::endl;
+	// Set up offscreen target and encoder
+	if(!CapturePath.empty()) {
+		CaptureTexture = SDL_CreateTexture(Renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_TARGET, Config.ScreenWidth, Config.ScreenHeight);
+		if(!CaptureTexture) {
+			std::cout << SDL_GetError() << std::endl;
+			return 1;
+		}
+		if(!Capture.Open(CapturePath, Config.ScreenWidth, Config.ScreenHeight, CAPTURE_FPS)) {
+			std::cout << "Cannot capture to " << CapturePath << ", the screen size must be even" << std::endl;
+			return 1;
+		}
+	}
+
+	// Wait for decoding to finish
+	uint64_t LoadStart = Trace.GetTime();
+	if(!Assets.FinishDecode()) {
+		std::cout << "Cannot load " << Assets.Missing << std::endl;
 		return 1;
 	}
+	Trace.Complete("wait_assets", LoadStart, "packed", Assets.IsPacked());
 
-	// Load textures
-	Texture = IMG_LoadTexture(Renderer, "image/player.png");
-	WallTexture = IMG_LoadTexture(Renderer, "image/wall.png");
-	BackTexture[0] = IMG_LoadTexture(Renderer, "image/back0.png");
-	BackTexture[1] = IMG_LoadTexture(Renderer, "image/back1.png");
-	if(!Texture || !WallTexture || !BackTexture[0] || !BackTexture[1]) {
+	// Load fonts and textures
+	LoadStart = Trace.GetTime();
+	Render = new _Render();
+	if(!Render->Load(Renderer, Assets)) {
 		std::cout << SDL_GetError() << std::endl;
 		return 1;
 	}
+	Assets.FreeImages();
+	Trace.Complete("load_graphics", LoadStart);
+	Render->VersionText.Append("Version: ").Append(Version.c_str());
 
 	// Init joystick
 	if(SDL_NumJoysticks() > 0)
@@ -175,23 +331,43 @@ int main(int ArgumentCount, char **Arguments) {
 	// Init game state
 	InitGame();
 
-	// Play music
-	if(Mix_PlayMusic(Music, -1) == -1) {
-		std::cout << SDL_GetError() << std::endl;
-		return 1;
-	}
-	Mix_VolumeMusic((int)(Config.MusicVolume * MIX_MAX_VOLUME));
-
 	// Init main gameloop
 	bool Quit = false;
+	FrameStats.Init(SDL_GetPerformanceFrequency());
 	Uint64 Timer = SDL_GetPerformanceCounter();
 	float TimeStep = GAME_TIMESTEP;
 	float TimeStepAccumulator = 0.0f;
+	_Input Input;
+	bool FirstFrame = true;
+
+	// Pace frames to the video rate while capturing, or the frame cap without vsync
+	_Pacer Pacer;
+	Pacer.Start(1.0 / (Capture.IsOpen() ? CAPTURE_FPS : GAME_MAXFPS), Config.PacerSpin / 1000.0);
+
+	// Jump presses waiting for their step, in SDL_GetTicks milliseconds
+	std::vector<double> JumpTimes;
+	double TicksOffset = SDL_GetTicks() + 0.5 - SDL_GetPerformanceCounter() * 1000.0 / SDL_GetPerformanceFrequency();
 	while(!Quit) {
 
 		// Get frametime
-		float FrameTime = (SDL_GetPerformanceCounter() - Timer) / (float)SDL_GetPerformanceFrequency();
-		Timer = SDL_GetPerformanceCounter();
+		Uint64 FrameStart = SDL_GetPerformanceCounter();
+		float FrameTime = (FrameStart - Timer) / (float)SDL_GetPerformanceFrequency();
+		if(Capture.IsOpen())
+			FrameTime = 1.0f / CAPTURE_FPS;
+		FrameStats.Add(PHASE_FRAME, FrameStart - Timer);
+		Timer = FrameStart;
+		uint64_t TraceFrameStart = Trace.GetTime();
+
+		// Start music once audio has loaded
+		if(Audio.Update()) {
+			if(Audio.IsReady())
+				std::cout << "Audio ready after " << (FrameStart - StartupTime) * 1000.0 / SDL_GetPerformanceFrequency() << " ms" << std::endl;
+			else
+				std::cout << Audio.GetError() << std::endl;
+			if(!Audio.GetMusicError().empty())
+				std::cout << "Cannot play music: " << Audio.GetMusicError() << std::endl;
+			Trace.Instant("audio_ready");
+		}
 
 		// Check for events
 		SDL_Event Event;
@@ -207,6 +383,8 @@ int main(int ArgumentCount, char **Arguments) {
 							Quit = true;
 						else if(Event.key.keysym.sym == SDLK_SPACE)
 							Action = true;
+						else if(Event.key.keysym.sym == SDLK_F3)
+							ShowFrameStats = !ShowFrameStats;
 					}
 				break;
 				case SDL_JOYBUTTONDOWN:
@@ -217,322 +395,254 @@ int main(int ArgumentCount, char **Arguments) {
 
 			// Handle player input
 			if(Action) {
-				if(State == STATE_PLAY) {
-					Player->Jump(JUMP_POWER);
-					if(Config.AudioEnabled)
-						Mix_PlayChannel(-1, JumpSound, 0);
+				if(Game->State == STATE_PLAY) {
+					if(!ReplayMode && !Autopilot) {
+						JumpTimes.push_back(Event.common.timestamp + 0.5);
+						Audio.Play(SOUND_JUMP);
+					}
 				}
-				else if(State == STATE_DIED && DiedTimer < 0) {
+				else if(Game->State == STATE_DIED && Game->DiedTimer < 0) {
+					JumpTimes.clear();
 					InitGame();
 				}
 			}
 		}
 
+		Uint64 PhaseStart = EndPhase(PHASE_EVENTS, FrameStart);
+
 		// Update timestep accumulator
 		TimeStepAccumulator += FrameTime;
-		if(TimeStepAccumulator > 3.0f)
+		if(TimeStepAccumulator > 3.0f) {
 			TimeStepAccumulator = 3.0f;
+			Trace.Instant("accumulator_clamp");
+		}
+		Trace.Counter("accumulator_ms", TimeStepAccumulator * 1000.0f);
+
+		// Restart automatically in attract mode
+		if(Autopilot && Game->State == STATE_DIED && Game->DiedTimer < 0)
+			InitGame();
+
+		// Stop capturing a replay once it's over
+		if(Capture.IsOpen() && ReplayMode && Game->State == STATE_DIED && Game->DiedTimer < 0)
+			Quit = true;
+
+		// Get the real time the first step of this frame stands for, on the clock of the event timestamps
+		double StepStart = FrameStart * 1000.0 / SDL_GetPerformanceFrequency() + TicksOffset - TimeStepAccumulator * 1000.0;
+
+		// Split one planner budget across the steps of this frame so catching up doesn't stall
+		if(Autopilot)
+			Autopilot->Planner.Budget = PLANNER_BUDGET / std::max(1, (int)(TimeStepAccumulator / TimeStep));
 
 		// Update game logic
+		int Updates = 0;
 		while(TimeStepAccumulator >= TimeStep) {
-			Update(TimeStep);
+			uint64_t UpdateStart = Trace.GetTime();
+			if(ReplayMode)
+				Input.Jump = Replay.GetJump(Game->Ticks, ReplayCursor, Input.JumpOffset);
+			else if(Autopilot && Game->State == STATE_PLAY)
+				Input.Jump = Autopilot->Jump(*Game);
+			else if(Capture.IsOpen()) {
+
+				// Game time doesn't follow real time while capturing, so jumps start with the next step
+				Input.Jump = !JumpTimes.empty();
+				JumpTimes.clear();
+			}
+			else
+				Input.Jump = TakeJump(JumpTimes, StepStart, TimeStep * 1000.0, Input.JumpOffset);
+
+			// Fly the ghosts through the same walls while the player is alive
+			if(Ghosts && Game->State == STATE_PLAY) {
+				Ghosts->GetFollowJumps(GhostMargins.data(), GhostJumps.data());
+				Ghosts->Step(GhostJumps.data());
+			}
+
+			uint32_t Tick = Game->Ticks;
+			int Events = Game->Step(Input);
+			if(Events & EVENT_JUMP) {
+				if(ReplayMode || Autopilot) {
+					Audio.Play(SOUND_JUMP);
+				}
+				if(!ReplayMode)
+					Replay.RecordJump(Tick, Input.JumpOffset);
+			}
+			if(Events & EVENT_DIED)
+				Died();
+			Input = _Input();
 			TimeStepAccumulator -= TimeStep;
+			StepStart += TimeStep * 1000.0;
+			Trace.Complete("update", UpdateStart, "tick", Tick);
+			Updates++;
 		}
 
+		PhaseStart = EndPhase(PHASE_UPDATE, PhaseStart);
+
 		// Draw state
-		Render(TimeStepAccumulator / TimeStep);
+		uint64_t RenderStart = Trace.GetTime();
+		if(Capture.IsOpen())
+			SDL_SetRenderTarget(Renderer, CaptureTexture);
+		Render->Draw(*Game, HighScore, TimeStepAccumulator / TimeStep, Ghosts);
+		if(ShowFrameStats)
+			Render->DrawFrameStats(FrameStats);
+
+		// Hand the frame to the encoder and show it
+		if(Capture.IsOpen()) {
+			uint8_t *Pixels = Capture.GetFrame();
+			if(Pixels && SDL_RenderReadPixels(Renderer, nullptr, SDL_PIXELFORMAT_ARGB8888, Pixels, Capture.GetPitch()) == 0)
+				Capture.Submit();
+
+			SDL_SetRenderTarget(Renderer, nullptr);
+			SDL_RenderCopy(Renderer, CaptureTexture, nullptr, nullptr);
+		}
+		Trace.Complete("render", RenderStart);
+		PhaseStart = EndPhase(PHASE_RENDER, PhaseStart);
+
+		// Render to screen
+		uint64_t PresentStart = Trace.GetTime();
+		SDL_RenderPresent(Renderer);
+		Trace.Complete("present", PresentStart);
+		if(FirstFrame) {
+			FirstFrame = false;
+			std::cout << "Time to first frame " << (SDL_GetPerformanceCounter() - StartupTime) * 1000.0 / SDL_GetPerformanceFrequency() << " ms" << std::endl;
+			Trace.Instant("first_frame");
+		}
+		PhaseStart = EndPhase(PHASE_PRESENT, PhaseStart);
 
 		// Limit framerate
-		if(!Config.Vsync) {
-			float ExtraTime = 1.0f / GAME_MAXFPS - FrameTime;
-			if(ExtraTime > 0.0f) {
-				SDL_Delay((Uint32)(ExtraTime * 1000));
-			}
-		}
+		if(Capture.IsOpen() || !Config.Vsync)
+			Pacer.Wait();
+		EndPhase(PHASE_DELAY, PhaseStart);
+		Trace.Complete("frame", TraceFrameStart, "updates", Updates);
 	}
 
+	// Save frame timings
+	FrameStats.SaveCSV(Config.GetConfigPath() + "frametimes.csv");
+	if(Pacer.GetFrames())
+		std::cout << "Frame interval mean=" << Pacer.GetMeanInterval() * 1000.0 << "ms jitter=" << Pacer.GetJitter() * 1000.0 << "ms max_error=" << Pacer.GetMaxError() * 1000.0 << "ms" << std::endl;
+
 	// Clean up
-	DeleteObjects();
-	SDL_DestroyTexture(Texture);
-	SDL_DestroyTexture(WallTexture);
-	TTF_CloseFont(Font);
+	delete Autopilot;
+	delete Ghosts;
+	delete Game;
+	delete Render;
 	SDL_JoystickClose(Joystick);
+	if(Capture.IsOpen()) {
+		Capture.Close();
+		std::cout << "Captured " << Capture.GetFrames() << " frames, dropped " << Capture.GetDropped() << std::endl;
+	}
+	SDL_DestroyTexture(CaptureTexture);
 	SDL_DestroyRenderer(Renderer);
 	SDL_DestroyWindow(Window);
-	if(Config.AudioEnabled) {
-		Mix_FreeChunk(DieSound);
-		Mix_FreeChunk(JumpSound);
-		Mix_FreeMusic(Music);
-		Mix_CloseAudio();
-		Mix_Quit();
-	}
+	Audio.Close();
+	Assets.Close();
+	IMG_Quit();
 	SDL_Quit();
 
 	Config.Close();
+	Trace.Close();
+	if(Trace.GetDropped())
+		std::cout << "Trace dropped " << Trace.GetDropped() << " events" << std::endl;
 
 	return 0;
 }
 
 // Player has died
 void Died() {
-	Mix_PlayChannel(-1, DieSound, 0);
+	Audio.Play(SOUND_DIE);
 
-	if(Time > HighScore) {
-		HighScore = Time;
+	if(Game->Time > HighScore) {
+		HighScore = Game->Time;
 	}
 
-	for(SpriteIteratorType WallsIterator = Walls.begin(); WallsIterator != Walls.end(); ++WallsIterator) {
-		(*WallsIterator)->Physics.SetVelocity(Vector2(0, 0));
-		(*WallsIterator)->Update(0);
+	std::cout << "Score=" << Game->Time << " Seed=" << Game->Seed << std::endl;
+	if(Autopilot && Autopilot->Planner.Plans)
+		std::cout << "Planner nodes/ms=" << (int)Autopilot->Planner.GetNodesPerMillisecond() << " ms/plan=" << Autopilot->Planner.Time * 1000.0 / Autopilot->Planner.Plans << std::endl;
+
+	// Check or save replay
+	if(ReplayMode) {
+		bool Verified = Game->Ticks == Replay.Ticks && Game->Time == Replay.Score;
+		std::cout << "Replay " << (Verified ? "verified" : "mismatch") << " ClaimedScore=" << Replay.Score << std::endl;
+	}
+	else {
+		Replay.Finish(*Game);
+		Replay.Save(Config.GetConfigPath() + "last.replay");
 	}
+}
 
-	State = STATE_DIED;
-	DiedTimer = DIED_WAIT_TIME;
+// Record time since the start of a phase and return the current time
+Uint64 EndPhase(FramePhaseType Phase, Uint64 StartTime) {
+	Uint64 Time = SDL_GetPerformanceCounter();
+	FrameStats.Add(Phase, Time - StartTime);
 
-	std::cout << "Score=" << Time << " Seed=" << Seed << std::endl;
+	return Time;
 }
 
 // Initialize game state
 void InitGame() {
+	uint64_t StartTime = Trace.GetTime();
 	GetNewSeed(true);
-	State = STATE_PLAY;
-	TextTexture = nullptr;
-	DeleteObjects();
-	Player = new _Player(_Physics(Vector2(100, 0), Vector2(0, 0), Vector2(0, GRAVITY)));
-	Player->Init(Texture);
-	SpawnTimer = 0.0f;
-	Time = 0.0f;
-
-	_Sprite *Background;
-	Background = new _Sprite();
-	Background->Texture = BackTexture[0];
-	Background->Bounds.w = Config.ScreenWidth;
-	Background->Bounds.h = Config.ScreenHeight;
-	Background->Physics = _Physics(Vector2(0, 0), Vector2(-5, 0), Vector2(0, 0));
-	Backgrounds.push_back(Background);
-
-	Background = new _Sprite();
-	Background->Texture = BackTexture[0];
-	Background->Bounds.w = Config.ScreenWidth;
-	Background->Bounds.h = Config.ScreenHeight;
-	Background->Physics = _Physics(Vector2(Config.ScreenWidth, 0), Vector2(-5, 0), Vector2(0, 0));
-	Backgrounds.push_back(Background);
-
-	Background = new _Sprite();
-	Background->Texture = BackTexture[1];
-	Background->Bounds.w = Config.ScreenWidth;
-	Background->Bounds.h = 200;
-	Background->Physics = _Physics(Vector2(0, Config.ScreenHeight - Background->Bounds.h), Vector2(-30, 0), Vector2(0, 0));
-	Backgrounds.push_back(Background);
-
-	Background = new _Sprite();
-	Background->Texture = BackTexture[1];
-	Background->Bounds.w = Config.ScreenWidth;
-	Background->Bounds.h = 200;
-	Background->Physics = _Physics(Vector2(Config.ScreenWidth, Config.ScreenHeight - Background->Bounds.h), Vector2(-30, 0), Vector2(0, 0));
-	Backgrounds.push_back(Background);
-
-	Background = new _Sprite();
-	Background->Texture = BackTexture[1];
-	Background->Bounds.w = Config.ScreenWidth;
-	Background->Bounds.h = 100;
-	Background->Physics = _Physics(Vector2(0, Config.ScreenHeight - Background->Bounds.h), Vector2(-50, 0), Vector2(0, 0));
-	Backgrounds.push_back(Background);
-
-	Background = new _Sprite();
-	Background->Texture = BackTexture[1];
-	Background->Bounds.w = Config.ScreenWidth;
-	Background->Bounds.h = 100;
-	Background->Physics = _Physics(Vector2(Config.ScreenWidth, Config.ScreenHeight - Background->Bounds.h), Vector2(-50, 0), Vector2(0, 0));
-	Backgrounds.push_back(Background);
-}
-
-// Check collisions between player and world
-void CheckCollision() {
-	if(Player->Physics.GetPosition().Y > Config.ScreenHeight + Player->Radius)
-		Died();
-
-	for(SpriteIteratorType WallsIterator = Walls.begin(); WallsIterator != Walls.end(); ++WallsIterator) {
-		_Sprite *Wall = *WallsIterator;
-		if(CheckWallCollision(Wall)) {
-			Died();
-		}
-	}
+	Game->Init(Seed);
+	if(Ghosts)
+		Ghosts->Init(Seed);
+	ReplayCursor = 0;
+	if(!ReplayMode)
+		Replay.Start(*Game);
+
+	Render->SeedText.Clear();
+	Render->SeedText.Append("Seed: ").Append(Game->Seed);
+	Trace.Complete("init_game", StartTime, "seed", Game->Seed);
 }
 
-// Update game
-void Update(float FrameTime) {
-	if(State == STATE_PLAY)
-		Time += FrameTime;
-
-	// Update player
-	Player->Update(FrameTime);
-
-	// Update walls
-	for(SpriteIteratorType WallsIterator = Walls.begin(); WallsIterator != Walls.end(); ) {
-		_Sprite *Wall = *WallsIterator;
-		Wall->Update(FrameTime);
-		if(Wall->Physics.GetPosition().X + Wall->Bounds.w < 0) {
-			delete Wall;
-			WallsIterator = Walls.erase(WallsIterator);
-		}
-		else {
-			++WallsIterator;
-		}
-	}
-
-	// Update backgrounds
-	for(SpriteIteratorType BackgroundIterator = Backgrounds.begin(); BackgroundIterator != Backgrounds.end(); ) {
-		_Sprite *Sprite = *BackgroundIterator;
-		Sprite->Update(FrameTime);
-		if(Sprite->Physics.GetPosition().X <= -Config.ScreenWidth) {
-			Sprite->Physics.SetPosition(Vector2(Config.ScreenWidth, Sprite->Physics.GetPosition().Y));
-			Sprite->Update(0);
-		}
-
-		++BackgroundIterator;
-	}
-
-	if(State == STATE_PLAY) {
-
-		// Spawn new walls
-		SpawnTimer -= FrameTime;
-		if(SpawnTimer <= 0.0f) {
-			float Low = Config.ScreenHeight/2 - SPAWN_RANGE;
-			float High = Config.ScreenHeight/2 + SPAWN_RANGE;
-			float Y = (float)GetRandomReal(Low, High);
-			SpawnWall(Y);
-			SpawnTimer = SPAWNTIME;
-		}
-
-		// Check collisions
-		CheckCollision();
-	}
-	else
-		DiedTimer -= FrameTime;
-}
-
-// Draw objects
-void Render(float Blend) {
-
-	// Clear screen
-	SDL_RenderClear(Renderer);
-
-	// Draw backgrounds
-	for(SpriteIteratorType BackgroundIterator = Backgrounds.begin(); BackgroundIterator != Backgrounds.end(); ++BackgroundIterator) {
-		(*BackgroundIterator)->Render(Renderer, Blend);
-	}
-
-	// Draw walls
-	for(SpriteIteratorType WallsIterator = Walls.begin(); WallsIterator != Walls.end(); ++WallsIterator) {
-		(*WallsIterator)->Render(Renderer, Blend);
-	}
-
-	// Draw player
-	Player->Render(Renderer, Blend);
-
-	// Draw stats
-	std::ostringstream Buffer;
-
-	Buffer << std::fixed << "Version: " << Version;
-	DrawText(Buffer.str(), Config.ScreenWidth - 160, 15, ColorWhite);
-	Buffer.str("");
-
-	Buffer << std::fixed << "Seed: " << Seed;
-	DrawText(Buffer.str(), Config.ScreenWidth - 160, 35, ColorWhite);
-	Buffer.str("");
-
-	Buffer << std::fixed << std::setprecision(2) << "Time: " << Time;
-	DrawText(Buffer.str(), Config.ScreenWidth - 160, 75, ColorWhite);
-	Buffer.str("");
-
-	Buffer << std::fixed << std::setprecision(2) << "High Score: " << HighScore;
-	DrawText(Buffer.str(), Config.ScreenWidth - 160, 95, ColorWhite);
-	Buffer.str("");
+// Parse a seed given as a whole 32-bit unsigned number
+bool ParseSeed(const std::string &Token, uint32_t &Value) {
+	if(Token.empty() || Token[0] < '0' || Token[0] > '9')
+		return false;
 
-	// Draw death message
-	if(State == STATE_DIED)
-		DrawText("You Died!", 10, 10, ColorRed);
+	char *Last;
+	unsigned long long Parsed = strtoull(Token.c_str(), &Last, 10);
+	if(*Last != '\0' || Parsed > UINT32_MAX)
+		return false;
 
-	// Render to screen
-	SDL_RenderPresent(Renderer);
+	Value = (uint32_t)Parsed;
+	return true;
 }
 
-// Create wall object
-void SpawnWall(float MidY) {
-	float StartY, EndY;
-	StartY = 0;
-	EndY = MidY - SPACING;
-	_Sprite *WallTop = new _Sprite();
-	WallTop->Texture = WallTexture;
-	WallTop->Physics = _Physics(Vector2(Config.ScreenWidth, StartY), Vector2(WALL_VELOCITY, 0), Vector2(0, 0));
-	WallTop->Bounds.w = (int)WALL_WIDTH;
-	WallTop->Bounds.h = (int)(EndY - StartY);
-	Walls.push_back(WallTop);
-
-	StartY = MidY + SPACING;
-	EndY = Config.ScreenHeight;
-	_Sprite *WallBottom = new _Sprite();
-	WallBottom->Texture = WallTexture;
-	WallBottom->Physics = _Physics(Vector2(Config.ScreenWidth, StartY), Vector2(WALL_VELOCITY, 0), Vector2(0, 0));
-	WallBottom->Bounds.w = (int)WALL_WIDTH;
-	WallBottom->Bounds.h = (int)(EndY - StartY);
-	Walls.push_back(WallBottom);
+// Print command line options
+void PrintUsage() {
+	std::cout << "Usage: openflap [options] [seed]\n";
+	std::cout << "  --autopilot             play with the planner\n";
+	std::cout << "  --ghosts N              fly N players alongside you\n";
+	std::cout << "  --trace FILE            write a trace of each frame\n";
+	std::cout << "  --replay FILE           watch a replay, or check it with --fast\n";
+	std::cout << "  --capture FILE          encode the replay to a y4m file\n";
+	std::cout << "  --verify-dir DIR        check every replay in a directory\n";
+	std::cout << "  --headless              play seeds without a window\n";
+	std::cout << "    --seeds A..B          range of seeds\n";
+	std::cout << "    --policy NAME         idle, random, follow or planner\n";
+	std::cout << "    --max-ticks N         longest game\n";
+	std::cout << "    --integrator NAME     rk4, analytic or euler\n";
+	std::cout << "    --tick-rate HZ        rate the policy decides at\n";
+	std::cout << "    --population N        fly N players through each seed\n";
+	std::cout << "    --threads N           number of workers\n";
+	std::cout << "    --quiet               only print the summary\n";
+	std::cout << "  --serve NAME            serve games through shared memory\n";
+	std::cout << "    --envs N              number of games\n";
+	std::cout << std::flush;
 }
 
-// Test collision between box and circle
-bool CheckWallCollision(_Sprite *Wall) {
-	float AABB[4] = { Wall->Physics.GetPosition().X, Wall->Physics.GetPosition().Y, Wall->Physics.GetPosition().X + Wall->Bounds.w, Wall->Physics.GetPosition().Y + Wall->Bounds.h };
-
-	// Get closest point on AABB
-	float X = Player->Physics.GetPosition().X;
-	float Y = Player->Physics.GetPosition().Y;
-	if(X < AABB[0])
-		X = AABB[0];
-	if(Y < AABB[1])
-		Y = AABB[1];
-	if(X > AABB[2])
-		X = AABB[2];
-	if(Y > AABB[3])
-		Y = AABB[3];
-
-	// Test circle collision with point
-	float DistanceX = X - Player->Physics.GetPosition().X;
-	float DistanceY = Y - Player->Physics.GetPosition().Y;
-	float DistanceSquared = (DistanceX * DistanceX + DistanceY * DistanceY);
-	bool Hit = DistanceSquared < Player->Radius * Player->Radius;
-
-	return Hit;
-}
-
-// Delete object data
-void DeleteObjects() {
+// Take jump presses made before the end of a step, getting how far into the step the last one was
+bool TakeJump(std::vector<double> &JumpTimes, double StepStart, double StepLength, uint8_t &Offset) {
+	size_t Count = 0;
+	while(Count < JumpTimes.size() && JumpTimes[Count] < StepStart + StepLength)
+		Count++;
 
-	delete Player;
-	for(SpriteIteratorType WallsIterator = Walls.begin(); WallsIterator != Walls.end(); ++WallsIterator) {
-		delete (*WallsIterator);
-	}
-	for(SpriteIteratorType BackgroundIterator = Backgrounds.begin(); BackgroundIterator != Backgrounds.end(); ++BackgroundIterator) {
-		delete (*BackgroundIterator);
-	}
+	if(!Count)
+		return false;
 
-	Backgrounds.clear();
-	Walls.clear();
-}
+	double SubTick = (JumpTimes[Count - 1] - StepStart) / StepLength * INPUT_SUBTICKS;
+	Offset = (uint8_t)std::min(std::max(SubTick, 0.0), INPUT_SUBTICKS - 1.0);
+	JumpTimes.erase(JumpTimes.begin(), JumpTimes.begin() + Count);
 
-// Render text
-void DrawText(const std::string &Text, int X, int Y, const SDL_Color &Color) {
-	SDL_Rect Bounds;
-	Bounds.x = X;
-	Bounds.y = Y;
-	if(TextTexture)
-		SDL_DestroyTexture(TextTexture);
-
-	SDL_Surface *TextSurface = TTF_RenderText_Blended(Font, Text.c_str(), Color);
-	TextTexture = SDL_CreateTextureFromSurface(Renderer, TextSurface);
-	SDL_QueryTexture(TextTexture, nullptr, nullptr, &Bounds.w, &Bounds.h);
-	SDL_RenderCopy(Renderer, TextTexture, nullptr, &Bounds);
-	SDL_FreeSurface(TextSurface);
+	return true;
 }
 
 // Set seed
@@ -549,9 +659,3 @@ int GetRandomInt(int Min, int Max) {
 	std::uniform_int_distribution<int> Distribution(Min, Max);
 	return Distribution(RandomGenerator);
 }
-
-// Return random double from Min to Max
-double GetRandomReal(double Min, double Max) {
-	std::uniform_real_distribution<double> Distribution(Min, Max);
-	return Distribution(RandomGenerator);
-}
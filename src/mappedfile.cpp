@@ -0,0 +1,110 @@
+/******************************************************************************
+* openflap
+* Copyright (C) 2014  Alan Witkowski
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*******************************************************************************/
+#include <mappedfile.h>
+#ifdef _WIN32
+	#include <windows.h>
+#else
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <fcntl.h>
+	#include <unistd.h>
+#endif
+
+// Empty files have no mapping but still open successfully
+static const uint8_t EmptyData[1] = { 0 };
+
+// Map file into memory
+bool _MappedFile::Open(const std::string &Path) {
+	Close();
+
+#ifdef _WIN32
+	HANDLE File = CreateFileA(Path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if(File == INVALID_HANDLE_VALUE)
+		return false;
+
+	LARGE_INTEGER FileSize;
+	if(!GetFileSizeEx(File, &FileSize)) {
+		CloseHandle(File);
+		return false;
+	}
+
+	Size = (size_t)FileSize.QuadPart;
+	if(Size == 0) {
+		CloseHandle(File);
+		Data = EmptyData;
+		return true;
+	}
+
+	HANDLE Mapping = CreateFileMappingA(File, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	CloseHandle(File);
+	if(!Mapping)
+		return false;
+
+	Data = (const uint8_t *)MapViewOfFile(Mapping, FILE_MAP_READ, 0, 0, 0);
+	if(!Data) {
+		CloseHandle(Mapping);
+		Size = 0;
+		return false;
+	}
+	Handle = Mapping;
+#else
+	int File = open(Path.c_str(), O_RDONLY);
+	if(File == -1)
+		return false;
+
+	struct stat Status;
+	if(fstat(File, &Status) != 0 || !S_ISREG(Status.st_mode)) {
+		close(File);
+		return false;
+	}
+
+	Size = (size_t)Status.st_size;
+	if(Size == 0) {
+		close(File);
+		Data = EmptyData;
+		return true;
+	}
+
+	void *Memory = mmap(nullptr, Size, PROT_READ, MAP_PRIVATE, File, 0);
+	close(File);
+	if(Memory == MAP_FAILED) {
+		Size = 0;
+		return false;
+	}
+	Data = (const uint8_t *)Memory;
+	Handle = Memory;
+#endif
+
+	return true;
+}
+
+// Unmap file
+void _MappedFile::Close() {
+	if(Handle) {
+#ifdef _WIN32
+		UnmapViewOfFile(Data);
+		CloseHandle((HANDLE)Handle);
+#else
+		munmap(Handle, Size);
+#endif
+	}
+
+	Data = nullptr;
+	Size = 0;
+	Handle = nullptr;
+}
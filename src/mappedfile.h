@@ -0,0 +1,48 @@
+/******************************************************************************
+* openflap
+* Copyright (C) 2014  Alan Witkowski
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*******************************************************************************/
+#pragma once
+
+// Libraries
+#include <stdint.h>
+#include <stddef.h>
+#include <string>
+
+// Read-only memory mapping of a whole file
+class _MappedFile {
+
+	public:
+
+		_MappedFile() : Data(nullptr), Size(0), Handle(nullptr) { }
+		~_MappedFile() { Close(); }
+
+		bool Open(const std::string &Path);
+		void Close();
+
+		const uint8_t *GetData() const { return Data; }
+		size_t GetSize() const { return Size; }
+
+	private:
+
+		_MappedFile(const _MappedFile &);
+		_MappedFile &operator=(const _MappedFile &);
+
+		const uint8_t *Data;
+		size_t Size;
+		void *Handle;
+
+};
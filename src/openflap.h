@@ -0,0 +1,91 @@
+/******************************************************************************
+* openflap
+* Copyright (C) 2014  Alan Witkowski
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*******************************************************************************/
+#pragma once
+
+// C interface to the simulation for external training loops.
+// Environments are games stepped in lockstep at 100 Hz with the same rules as the game itself.
+// A game that ends is reset with its seed plus the number of environments, in the same step.
+
+#include <stdint.h>
+
+#ifdef _WIN32
+	#ifdef OPENFLAP_BUILD
+		#define OPENFLAP_API __declspec(dllexport)
+	#else
+		#define OPENFLAP_API __declspec(dllimport)
+	#endif
+#else
+	#define OPENFLAP_API __attribute__((visibility("default")))
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Incremented when a function or buffer layout changes
+#define OPENFLAP_API_VERSION 3
+
+// Floats per environment in the observation buffer
+#define OPENFLAP_OBSERVATION_SIZE 4
+
+// Observation layout, in pixels and pixels per second
+enum {
+	OPENFLAP_OBSERVATION_PLAYER_Y,
+	OPENFLAP_OBSERVATION_VELOCITY_Y,
+	OPENFLAP_OBSERVATION_GAP_DISTANCE,
+	OPENFLAP_OBSERVATION_GAP_Y,
+};
+
+// Causes of death reported by openflap_get_result
+enum {
+	OPENFLAP_DEATH_NONE,
+	OPENFLAP_DEATH_FALL,
+	OPENFLAP_DEATH_WALL,
+};
+
+typedef struct openflap_env openflap_env;
+
+OPENFLAP_API int openflap_api_version(void);
+
+// Create n_envs games, seeding environment i with seeds[i], or with i when seeds is null. Returns null on failure.
+OPENFLAP_API openflap_env *openflap_create(int n_envs, const uint32_t *seeds);
+OPENFLAP_API void openflap_destroy(openflap_env *env);
+
+// Set the caller's buffers that openflap_reset and openflap_step write into: n_envs * OPENFLAP_OBSERVATION_SIZE
+// observations, n_envs rewards and n_envs done flags. Rewards and done flags may be null. Returns 0 on success.
+OPENFLAP_API int openflap_set_buffers(openflap_env *env, float *observations, float *rewards, uint8_t *dones);
+
+// Restart every game, with new seeds or, when seeds is null, the ones given to openflap_create.
+// Returns 0 on success, or -1 before openflap_set_buffers.
+OPENFLAP_API int openflap_reset(openflap_env *env, const uint32_t *seeds);
+
+// Advance every game one 10ms tick, jumping where actions[i] is nonzero. Each tick survived is worth 0.01,
+// so rewards over a game add up to its score. Returns the number of games that ended, or -1 before
+// openflap_set_buffers or without actions.
+OPENFLAP_API int openflap_step(openflap_env *env, const uint8_t *actions);
+
+// Get the result of a game that ended in the last step. Returns 0 when environment i didn't end.
+OPENFLAP_API int openflap_get_result(const openflap_env *env, int i, float *score, uint32_t *ticks, int *death, uint32_t *seed);
+
+// Draw every game into n_envs consecutive width * height grayscale frames, one byte per pixel, row by row.
+// Returns 0 on success.
+OPENFLAP_API int openflap_render(openflap_env *env, int width, int height, uint8_t *frames);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,82 @@
+/******************************************************************************
+* openflap
+* Copyright (C) 2014  Alan Witkowski
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*******************************************************************************/
+#include <pacer.h>
+#include <thread>
+#include <cmath>
+
+// Constructor
+_Pacer::_Pacer() :
+	Interval(0),
+	SpinTime(0),
+	Frames(0),
+	Sum(0.0),
+	SumSquares(0.0),
+	MaxError(0.0),
+	Target(0.0) {
+}
+
+// Set the frame interval and how long before each deadline to stop sleeping, in seconds
+void _Pacer::Start(double Interval, double SpinTime) {
+	this->Interval = std::chrono::duration_cast<ClockType::duration>(std::chrono::duration<double>(Interval));
+	this->SpinTime = std::chrono::duration_cast<ClockType::duration>(std::chrono::duration<double>(SpinTime));
+	Target = Interval;
+	Deadline = LastWake = ClockType::now();
+	Frames = 0;
+	Sum = SumSquares = MaxError = 0.0;
+}
+
+// Wait for the next deadline
+void _Pacer::Wait() {
+	Deadline += Interval;
+
+	// Deadlines advance by whole intervals so sleep error doesn't add up, unless a long frame left us more than an interval behind
+	ClockType::time_point Now = ClockType::now();
+	if(Now - Deadline > Interval)
+		Deadline = Now;
+
+	// Sleep while the OS can be trusted to wake us in time, then spin
+	if(Deadline - Now > SpinTime)
+		std::this_thread::sleep_for(Deadline - Now - SpinTime);
+	while(ClockType::now() < Deadline)
+		std::this_thread::yield();
+
+	// Track achieved interval
+	Now = ClockType::now();
+	double Elapsed = std::chrono::duration<double>(Now - LastWake).count();
+	LastWake = Now;
+	Frames++;
+	Sum += Elapsed;
+	SumSquares += Elapsed * Elapsed;
+	if(std::abs(Elapsed - Target) > MaxError)
+		MaxError = std::abs(Elapsed - Target);
+}
+
+// Get mean achieved interval in seconds
+double _Pacer::GetMeanInterval() const {
+	return Frames ? Sum / Frames : 0.0;
+}
+
+// Get standard deviation of achieved intervals in seconds
+double _Pacer::GetJitter() const {
+	if(!Frames)
+		return 0.0;
+
+	double Mean = Sum / Frames;
+	double Variance = SumSquares / Frames - Mean * Mean;
+	return Variance > 0.0 ? std::sqrt(Variance) : 0.0;
+}
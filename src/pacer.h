@@ -0,0 +1,55 @@
+/******************************************************************************
+* openflap
+* Copyright (C) 2014  Alan Witkowski
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*******************************************************************************/
+#pragma once
+
+// Libraries
+#include <stdint.h>
+#include <chrono>
+
+// Holds a loop to a fixed rate with absolute deadlines, sleeping and then spinning for the last stretch
+class _Pacer {
+
+	public:
+
+		_Pacer();
+
+		void Start(double Interval, double SpinTime);
+		void Wait();
+
+		uint64_t GetFrames() const { return Frames; }
+		double GetMeanInterval() const;
+		double GetJitter() const;
+		double GetMaxError() const { return MaxError; }
+
+	private:
+
+		typedef std::chrono::steady_clock ClockType;
+
+		ClockType::time_point Deadline;
+		ClockType::time_point LastWake;
+		ClockType::duration Interval;
+		ClockType::duration SpinTime;
+
+		// Achieved intervals in seconds
+		uint64_t Frames;
+		double Sum;
+		double SumSquares;
+		double MaxError;
+		double Target;
+
+};
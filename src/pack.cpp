@@ -0,0 +1,164 @@
+/******************************************************************************
+* openflap
+* Copyright (C) 2014  Alan Witkowski
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*******************************************************************************/
+#include <pack.h>
+#include <fstream>
+#include <iterator>
+#include <cstring>
+
+// File layout:
+//   "OFPK", format version byte, entry count as a little-endian 32-bit value,
+//   then per entry a name length byte, the name characters, and the offset and
+//   size of its data as little-endian 32-bit values. File data follows the
+//   index, each aligned to PACK_ALIGNMENT bytes.
+static const char PACK_MAGIC[4] = { 'O', 'F', 'P', 'K' };
+static const uint8_t PACK_FORMAT = 1;
+static const size_t PACK_ALIGNMENT = 16;
+
+// Write little-endian 32-bit value
+static void WriteUInt32(std::vector<uint8_t> &Data, uint32_t Value) {
+	for(int i = 0; i < 4; i++)
+		Data.push_back((uint8_t)(Value >> (i * 8)));
+}
+
+// Overwrite little-endian 32-bit value
+static void PatchUInt32(std::vector<uint8_t> &Data, size_t Position, uint32_t Value) {
+	for(int i = 0; i < 4; i++)
+		Data[Position + i] = (uint8_t)(Value >> (i * 8));
+}
+
+// Read little-endian 32-bit value
+static bool ReadUInt32(const uint8_t *&Data, const uint8_t *End, uint32_t &Value) {
+	if(End - Data < 4)
+		return false;
+
+	Value = (uint32_t)Data[0] | ((uint32_t)Data[1] << 8) | ((uint32_t)Data[2] << 16) | ((uint32_t)Data[3] << 24);
+	Data += 4;
+
+	return true;
+}
+
+// Map pack and read its index
+bool _Pack::Open(const std::string &Path) {
+	Close();
+	if(!File.Open(Path))
+		return false;
+
+	const uint8_t *Data = File.GetData();
+	const uint8_t *End = Data + File.GetSize();
+	if(File.GetSize() < 5 || memcmp(Data, PACK_MAGIC, 4) != 0 || Data[4] != PACK_FORMAT) {
+		Close();
+		return false;
+	}
+	Data += 5;
+
+	uint32_t Count;
+	if(!ReadUInt32(Data, End, Count) || Count > (uint32_t)(End - Data)) {
+		Close();
+		return false;
+	}
+
+	// Read index, checking that every entry lies inside the file
+	Entries.resize(Count);
+	for(uint32_t i = 0; i < Count; i++) {
+		_Entry &Entry = Entries[i];
+		if(Data == End) {
+			Close();
+			return false;
+		}
+
+		size_t NameLength = *Data++;
+		if((size_t)(End - Data) < NameLength) {
+			Close();
+			return false;
+		}
+		Entry.Name.assign((const char *)Data, NameLength);
+		Data += NameLength;
+
+		if(!ReadUInt32(Data, End, Entry.Offset) || !ReadUInt32(Data, End, Entry.Size) || Entry.Offset > File.GetSize() || Entry.Size > File.GetSize() - Entry.Offset) {
+			Close();
+			return false;
+		}
+	}
+
+	return true;
+}
+
+// Unmap pack
+void _Pack::Close() {
+	File.Close();
+	Entries.clear();
+}
+
+// Get the mapped data of a file
+bool _Pack::Find(const std::string &Name, const uint8_t *&Data, size_t &Size) const {
+	for(size_t i = 0; i < Entries.size(); i++) {
+		if(Entries[i].Name == Name) {
+			Data = File.GetData() + Entries[i].Offset;
+			Size = Entries[i].Size;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+// Write a pack containing the named files from a directory
+bool _Pack::Build(const std::string &Path, const std::string &Directory, const std::vector<std::string> &Names) {
+	std::vector<uint8_t> Data;
+	for(int i = 0; i < 4; i++)
+		Data.push_back((uint8_t)PACK_MAGIC[i]);
+	Data.push_back(PACK_FORMAT);
+	WriteUInt32(Data, (uint32_t)Names.size());
+
+	// Write index with offsets filled in later
+	std::vector<size_t> Positions;
+	for(size_t i = 0; i < Names.size(); i++) {
+		if(Names[i].size() > 255)
+			return false;
+
+		Data.push_back((uint8_t)Names[i].size());
+		Data.insert(Data.end(), Names[i].begin(), Names[i].end());
+		Positions.push_back(Data.size());
+		WriteUInt32(Data, 0);
+		WriteUInt32(Data, 0);
+	}
+
+	// Append files
+	for(size_t i = 0; i < Names.size(); i++) {
+		std::ifstream InputFile((Directory + Names[i]).c_str(), std::ios::binary);
+		if(!InputFile.is_open())
+			return false;
+
+		Data.resize((Data.size() + PACK_ALIGNMENT - 1) / PACK_ALIGNMENT * PACK_ALIGNMENT);
+		size_t Offset = Data.size();
+		Data.insert(Data.end(), std::istreambuf_iterator<char>(InputFile), std::istreambuf_iterator<char>());
+		if(Data.size() > UINT32_MAX)
+			return false;
+
+		PatchUInt32(Data, Positions[i], (uint32_t)Offset);
+		PatchUInt32(Data, Positions[i] + 4, (uint32_t)(Data.size() - Offset));
+	}
+
+	std::ofstream OutputFile(Path.c_str(), std::ios::binary);
+	if(!OutputFile.is_open())
+		return false;
+
+	OutputFile.write((const char *)Data.data(), Data.size());
+
+	return OutputFile.good();
+}
@@ -0,0 +1,51 @@
+/******************************************************************************
+* openflap
+* Copyright (C) 2014  Alan Witkowski
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*******************************************************************************/
+#pragma once
+
+// Libraries
+#include <mappedfile.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <string>
+#include <vector>
+
+// Read-only archive of game data files, mapped into memory with an index
+class _Pack {
+
+	public:
+
+		bool Open(const std::string &Path);
+		void Close();
+		bool IsOpen() const { return File.GetData() != nullptr; }
+
+		bool Find(const std::string &Name, const uint8_t *&Data, size_t &Size) const;
+
+		static bool Build(const std::string &Path, const std::string &Directory, const std::vector<std::string> &Names);
+
+	private:
+
+		struct _Entry {
+			std::string Name;
+			uint32_t Offset;
+			uint32_t Size;
+		};
+
+		_MappedFile File;
+		std::vector<_Entry> Entries;
+
+};
@@ -18,12 +18,14 @@
 #include <physics.h>
 
 // Constructor
-_Physics::_Physics() {
+_Physics::_Physics() :
+	Integrator(INTEGRATOR_RK4) {
 
 }
 
 // Constructor
 _Physics::_Physics(const Vector2 &Position, const Vector2 &Velocity, const Vector2 &Acceleration) :
+	Integrator(INTEGRATOR_RK4),
 	LastPosition(Position),
 	Position(Position),
 	Velocity(Velocity),
@@ -32,6 +34,21 @@ _Physics::_Physics(const Vector2 &Position, const Vector2 &Velocity, const Vecto
 
 // Integrate
 void _Physics::Update(float FrameTime) {
+	switch(Integrator) {
+		case INTEGRATOR_RK4:
+			UpdateRungeKutta4(FrameTime);
+		break;
+		case INTEGRATOR_ANALYTIC:
+			UpdateAnalytic(FrameTime);
+		break;
+		case INTEGRATOR_EULER:
+			UpdateEuler(FrameTime);
+		break;
+	}
+}
+
+// Integrate with fourth order Runge-Kutta
+void _Physics::UpdateRungeKutta4(float FrameTime) {
 
 	// RK4 increments
 	_Physics A, B, C, D;
@@ -50,6 +67,20 @@ void _Physics::Update(float FrameTime) {
 	Velocity = Velocity + VelocityChange * FrameTime;
 }
 
+// Integrate with the exact solution for constant acceleration
+void _Physics::UpdateAnalytic(float FrameTime) {
+	LastPosition = Position;
+	Position = Position + Velocity * FrameTime + Acceleration * (0.5f * FrameTime * FrameTime);
+	Velocity = Velocity + Acceleration * FrameTime;
+}
+
+// Integrate with semi-implicit Euler
+void _Physics::UpdateEuler(float FrameTime) {
+	LastPosition = Position;
+	Velocity = Velocity + Acceleration * FrameTime;
+	Position = Position + Velocity * FrameTime;
+}
+
 // Evaluate increments
 void _Physics::RungeKutta4Evaluate(const _Physics &Derivative, float FrameTime, _Physics &Output) {
 
@@ -20,6 +20,13 @@
 // Libraries
 #include <vector2.h>
 
+// Integration methods
+enum IntegratorType {
+	INTEGRATOR_RK4,
+	INTEGRATOR_ANALYTIC,
+	INTEGRATOR_EULER,
+};
+
 // Physics data
 class _Physics {
 
@@ -31,11 +38,13 @@ class _Physics {
 		// Update
 		void Update(float FrameTime);
 
+		void SetIntegrator(IntegratorType Integrator) { this->Integrator = Integrator; }
 		void SetAcceleration(const Vector2 &Acceleration) { this->Acceleration = Acceleration; }
 		void SetLastPosition(const Vector2 &LastPosition) { this->LastPosition = LastPosition; }
 		void SetPosition(const Vector2 &Position) { this->Position = Position; }
 		void SetVelocity(const Vector2 &Velocity) { this->Velocity = Velocity; }
 
+		IntegratorType GetIntegrator() const { return Integrator; }
 		const Vector2 &GetAcceleration() const { return Acceleration; }
 		const Vector2 &GetLastPosition() const { return LastPosition; }
 		const Vector2 &GetPosition() const { return Position; }
@@ -43,9 +52,13 @@ class _Physics {
 
 	private:
 
+		void UpdateRungeKutta4(float FrameTime);
+		void UpdateAnalytic(float FrameTime);
+		void UpdateEuler(float FrameTime);
 		void RungeKutta4Evaluate(const _Physics &Derivative, float FrameTime, _Physics &Output);
 
 		// State
+		IntegratorType Integrator;
 		Vector2 LastPosition, Position;
 		Vector2 Velocity;
 		Vector2 Acceleration;
@@ -0,0 +1,172 @@
+/******************************************************************************
+* openflap
+* Copyright (C) 2014  Alan Witkowski
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*******************************************************************************/
+#include <planner.h>
+#include <constants.h>
+#include <algorithm>
+#include <cmath>
+
+// Constructor
+_Planner::_Planner(int Width, int Depth, double Budget) :
+	Width(Width),
+	Depth(Depth),
+	Budget(Budget),
+	Plans(0),
+	Nodes(0),
+	Time(0.0),
+	Floor(0.0f) {
+}
+
+// Decide whether to jump this tick. A Budget of zero searches the full depth every time.
+bool _Planner::Plan(const _Game &Game) {
+	std::chrono::steady_clock::time_point StartTime = std::chrono::steady_clock::now();
+	std::chrono::steady_clock::duration HalfBudget = std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(Budget * 0.5));
+
+	Beam.resize(Width * 2);
+	NextBeam.resize(Width * 2);
+	Order.resize(Width * 2);
+	BuildTimeline(Game);
+
+	// Search each first action with its own beam so neither gets pruned early
+	int FallDepth, JumpDepth;
+	float FallScore, JumpScore;
+	Search(Game, false, StartTime + HalfBudget, FallDepth, FallScore);
+	Search(Game, true, std::chrono::steady_clock::now() + HalfBudget, JumpDepth, JumpScore);
+
+	Plans++;
+	Time += std::chrono::duration<double>(std::chrono::steady_clock::now() - StartTime).count();
+
+	// Only jump when it survives longer or ends up closer to the gaps
+	return JumpDepth > FallDepth || (JumpDepth == FallDepth && JumpScore > FallScore);
+}
+
+// Record the walls near the player for each tick of the horizon by running a copy of the game with a ghost player
+void _Planner::BuildTimeline(const _Game &Game) {
+	const _Player &Player = Game.Player;
+	float Left = Player.Physics.GetPosition().X - Player.Radius;
+	float Right = Player.Physics.GetPosition().X + Player.Radius;
+	Floor = Game.ScreenHeight + Player.Radius;
+
+	// A player with no radius can't hit walls, and one resting at the top of the screen can't fall, so the walls run the full horizon
+	_Game Future = Game;
+	Future.TicksPerStep = 1;
+	Future.Player.Radius = 0.0f;
+	Future.Player.Physics = _Physics(Vector2(Player.Physics.GetPosition().X, 0), Vector2(0, 0), Vector2(0, 0));
+
+	Boxes.clear();
+	FrameStart.resize(Depth + 1);
+	FrameGap.resize(Depth);
+	for(int Tick = 0; Tick < Depth; Tick++) {
+		Future.Step(_Input());
+
+		FrameStart[Tick] = (int)Boxes.size();
+		for(int i = 0; i < Future.Walls.GetCount(); i++) {
+			int Index = Future.Walls.GetIndex(i);
+			_Box Box = { Future.Walls.X[Index], Future.Walls.Y[Index], Future.Walls.X[Index] + Future.Walls.Width[Index], Future.Walls.Y[Index] + Future.Walls.Height[Index] };
+			if(Box.Left < Right && Box.Right > Left)
+				Boxes.push_back(Box);
+		}
+
+		float GapX;
+		if(!Future.GetNextGap(GapX, FrameGap[Tick]))
+			FrameGap[Tick] = Game.ScreenHeight / 2;
+	}
+	FrameStart[Depth] = (int)Boxes.size();
+}
+
+// Run a beam search after the first action and return how deep it survived and the best score there
+void _Planner::Search(const _Game &Game, bool FirstJump, std::chrono::steady_clock::time_point Deadline, int &Survived, float &Score) {
+	Survived = 0;
+	Score = -HUGE_VALF;
+
+	// Start from the current state
+	Beam[0].Player = Game.Player;
+	Beam[0].Cooldown = 0;
+	Beam[0].Score = 0.0f;
+	Order[0] = 0;
+	int Count = 1;
+
+	for(int Tick = 0; Tick < Depth; Tick++) {
+
+		// Expand each path with a jump and a fall, rejecting children that collide
+		int NextCount = 0;
+		for(int i = 0; i < Count; i++) {
+			const _Node &Parent = Beam[Order[i]];
+			for(int Action = 0; Action < 2; Action++) {
+				bool Jump = Action == 1;
+				if(Tick == 0 ? Jump != FirstJump : Jump && Parent.Cooldown > 0)
+					continue;
+
+				_Node &Child = NextBeam[NextCount];
+				Child.Player = Parent.Player;
+				if(Jump)
+					Child.Player.Jump(JUMP_POWER);
+				Child.Player.Update(GAME_TIMESTEP);
+				Nodes++;
+
+				if(Child.Player.Physics.GetPosition().Y > Floor)
+					continue;
+
+				bool Hit = false;
+				for(int j = FrameStart[Tick]; j < FrameStart[Tick + 1] && !Hit; j++)
+					Hit = _Game::CheckWallCollision(Child.Player, Boxes[j].Left, Boxes[j].Top, Boxes[j].Right, Boxes[j].Bottom);
+				if(Hit)
+					continue;
+
+				// Prefer staying near the middle of the next gap
+				Child.Cooldown = Jump ? PLANNER_COOLDOWN : Parent.Cooldown - 1;
+				Child.Score = -std::fabs(Child.Player.Physics.GetPosition().Y - FrameGap[Tick]);
+				NextCount++;
+			}
+		}
+
+		// Every path dies
+		if(!NextCount)
+			break;
+
+		// Keep the best paths for the next level
+		std::swap(Beam, NextBeam);
+		Count = Prune(NextCount);
+		Survived = Tick + 1;
+		Score = Beam[Order[0]].Score;
+		if(Budget > 0.0 && std::chrono::steady_clock::now() >= Deadline)
+			break;
+	}
+}
+
+// Order paths from best to worst, merging near duplicates, and return how many fit in the beam
+int _Planner::Prune(int Count) {
+	for(int i = 0; i < Count; i++)
+		Order[i] = i;
+
+	std::sort(Order.begin(), Order.begin() + Count, [this](int A, int B) {
+		return Beam[A].Score > Beam[B].Score || (Beam[A].Score == Beam[B].Score && A < B);
+	});
+
+	// Paths with the same score have the same height, so duplicates end up next to each other
+	int Keep = 1;
+	for(int i = 1; i < Count && Keep < Width; i++) {
+		const _Physics &Physics = Beam[Order[i]].Player.Physics;
+		const _Physics &Last = Beam[Order[Keep - 1]].Player.Physics;
+		if(std::fabs(Physics.GetPosition().Y - Last.GetPosition().Y) < PLANNER_MERGE_DISTANCE && std::fabs(Physics.GetVelocity().Y - Last.GetVelocity().Y) < PLANNER_MERGE_VELOCITY)
+			continue;
+
+		Order[Keep++] = Order[i];
+	}
+
+	return Keep;
+}
@@ -0,0 +1,73 @@
+/******************************************************************************
+* openflap
+* Copyright (C) 2014  Alan Witkowski
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*******************************************************************************/
+#pragma once
+
+// Libraries
+#include <game.h>
+#include <stdint.h>
+#include <chrono>
+#include <vector>
+
+// Searches future jump timings with a bounded beam against the known wall stream
+class _Planner {
+
+	public:
+
+		_Planner(int Width, int Depth, double Budget);
+
+		bool Plan(const _Game &Game);
+
+		double GetNodesPerMillisecond() const { return Time > 0.0 ? Nodes / (Time * 1000.0) : 0.0; }
+
+		// Attributes
+		int Width, Depth;
+		double Budget;
+
+		// Stats
+		uint64_t Plans;
+		uint64_t Nodes;
+		double Time;
+
+	private:
+
+		// One path in the beam
+		struct _Node {
+			_Player Player;
+			int Cooldown;
+			float Score;
+		};
+
+		// Wall that the player could touch on a given tick
+		struct _Box {
+			float Left, Top, Right, Bottom;
+		};
+
+		void BuildTimeline(const _Game &Game);
+		void Search(const _Game &Game, bool FirstJump, std::chrono::steady_clock::time_point Deadline, int &Survived, float &Score);
+		int Prune(int Count);
+
+		// Walls and gap for each future tick
+		std::vector<_Box> Boxes;
+		std::vector<int> FrameStart;
+		std::vector<float> FrameGap;
+		float Floor;
+
+		std::vector<_Node> Beam, NextBeam;
+		std::vector<int> Order;
+
+};
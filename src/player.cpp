@@ -16,12 +16,10 @@
 * along with this program.  If not, see <http://www.gnu.org/licenses/>.
 *******************************************************************************/
 #include <player.h>
+#include <constants.h>
 
-void _Player::Init(SDL_Texture *Texture) {
-	Sprite.w = 64;
-	Sprite.h = 64;
-	Radius = 32;
-	this->Texture = Texture;
+void _Player::Init() {
+	Radius = PLAYER_RADIUS;
 }
 
 void _Player::Update(float FrameTime) {
@@ -33,12 +31,3 @@ void _Player::Update(float FrameTime) {
 void _Player::Jump(float Power) {
 	Physics.SetVelocity(Vector2(0, Power));
 }
-
-void _Player::Render(SDL_Renderer *Renderer, float Blend) {
-	const Vector2 &Position = Physics.GetPosition();
-	const Vector2 &LastPosition = Physics.GetLastPosition();
-	Sprite.x = (int)(Position.X * Blend + LastPosition.X * (1.0f - Blend) + 0.5f) - 32;
-	Sprite.y = (int)(Position.Y * Blend + LastPosition.Y * (1.0f - Blend) + 0.5f) - 32;
-
-	SDL_RenderCopy(Renderer, Texture, nullptr, &Sprite);
-}
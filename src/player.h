@@ -18,7 +18,6 @@
 #pragma once
 
 // Libraries
-#include <SDL2/SDL.h>
 #include <vector2.h>
 #include <physics.h>
 
@@ -27,18 +26,15 @@ class _Player {
 
 	public:
 
-		_Player(const _Physics &Physics) : Physics(Physics), Texture(nullptr) { }
-		~_Player() { }
+		_Player() : Radius(0.0f) { }
+		_Player(const _Physics &Physics) : Radius(0.0f), Physics(Physics) { }
 
-		void Init(SDL_Texture *Texture);
+		void Init();
 		void Update(float FrameTime);
 		void Jump(float Power);
-		void Render(SDL_Renderer *Renderer, float Blend);
 
 		float Radius;
 		_Physics Physics;
-		SDL_Rect Sprite;
-		SDL_Texture *Texture;
 
 };
 
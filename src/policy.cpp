@@ -0,0 +1,59 @@
+/******************************************************************************
+* openflap
+* Copyright (C) 2014  Alan Witkowski
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*******************************************************************************/
+#include <policy.h>
+#include <game.h>
+#include <constants.h>
+
+// Create a policy by name. The planner searches its full depth so results are reproducible.
+_Policy *CreatePolicy(const std::string &Name) {
+	if(Name == "idle")
+		return new _IdlePolicy();
+	else if(Name == "random")
+		return new _RandomPolicy();
+	else if(Name == "follow")
+		return new _FollowPolicy();
+	else if(Name == "planner")
+		return new _PlannerPolicy(0.0);
+
+	return nullptr;
+}
+
+// Seed the policy's own generator so runs stay reproducible
+void _RandomPolicy::Reset(uint32_t Seed) {
+	RandomGenerator.seed(Seed);
+}
+
+// Jump roughly every fifth of a second
+bool _RandomPolicy::Jump(const _Game &Game) {
+	std::uniform_int_distribution<int> Distribution(0, 19);
+	return Distribution(RandomGenerator) == 0;
+}
+
+// Jump just before the player would touch the bottom of the next gap
+bool _FollowPolicy::Jump(const _Game &Game) {
+	const _Physics &Physics = Game.Player.Physics;
+
+	float GapX, GapY;
+	if(!Game.GetNextGap(GapX, GapY))
+		GapY = Game.ScreenHeight / 2;
+
+	float Bottom = GapY + SPACING - Game.Player.Radius;
+	float NextY = Physics.GetPosition().Y + (Physics.GetVelocity().Y + GRAVITY * GAME_TIMESTEP) * GAME_TIMESTEP;
+
+	return Physics.GetVelocity().Y > 0.0f && NextY >= Bottom;
+}
@@ -0,0 +1,84 @@
+/******************************************************************************
+* openflap
+* Copyright (C) 2014  Alan Witkowski
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*******************************************************************************/
+#pragma once
+
+// Libraries
+#include <stdint.h>
+#include <string>
+#include <random>
+#include <constants.h>
+#include <planner.h>
+
+// Decides when a simulated player should jump
+class _Policy {
+
+	public:
+
+		virtual ~_Policy() { }
+
+		virtual void Reset(uint32_t Seed) { }
+		virtual bool Jump(const _Game &Game) = 0;
+
+};
+
+// Never jump
+class _IdlePolicy : public _Policy {
+
+	public:
+
+		bool Jump(const _Game &Game) override { return false; }
+
+};
+
+// Jump at random intervals
+class _RandomPolicy : public _Policy {
+
+	public:
+
+		void Reset(uint32_t Seed) override;
+		bool Jump(const _Game &Game) override;
+
+	private:
+
+		std::mt19937 RandomGenerator;
+
+};
+
+// Jump just before falling out of the next gap
+class _FollowPolicy : public _Policy {
+
+	public:
+
+		bool Jump(const _Game &Game) override;
+
+};
+
+// Search ahead for jump timings that get through the coming walls
+class _PlannerPolicy : public _Policy {
+
+	public:
+
+		_PlannerPolicy(double Budget) : Planner(PLANNER_WIDTH, PLANNER_DEPTH, Budget) { }
+
+		bool Jump(const _Game &Game) override { return Planner.Plan(Game); }
+
+		_Planner Planner;
+
+};
+
+_Policy *CreatePolicy(const std::string &Name);
@@ -0,0 +1,233 @@
+/******************************************************************************
+* openflap
+* Copyright (C) 2014  Alan Witkowski
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*******************************************************************************/
+#include <population.h>
+#include <game.h>
+#include <constants.h>
+#include <xmmintrin.h>
+#include <algorithm>
+#include <cstring>
+#include <random>
+
+// Constructor
+_Population::_Population(int Count, int ScreenWidth, int ScreenHeight) :
+	Seed(0),
+	Ticks(0),
+	Time(0.0f),
+	SpawnTimer(0.0f),
+	ScreenWidth(ScreenWidth),
+	ScreenHeight(ScreenHeight),
+	Count(Count),
+	PaddedCount((Count + _Batch::WIDTH - 1) / _Batch::WIDTH * _Batch::WIDTH),
+	Alive(0),
+	WallSlots(_Batch::CountWallSlots(ScreenWidth)) {
+
+	PlayerY.resize(PaddedCount);
+	VelocityY.resize(PaddedCount);
+	Living.resize(PaddedCount);
+	Death.resize(PaddedCount);
+	FinalTicks.resize(PaddedCount);
+	FinalTime.resize(PaddedCount);
+	WallX.assign(WallSlots, BATCH_NO_WALL);
+	WallTopBottom.resize(WallSlots);
+	WallBottomTop.resize(WallSlots);
+	WallBottomBottom.resize(WallSlots);
+	NearDistanceXSquared.resize(WallSlots);
+	NearSlots.resize(WallSlots);
+}
+
+// Start every player at the start of a game, matching _Game::Init
+void _Population::Init(uint32_t Seed) {
+	this->Seed = Seed;
+	RandomGenerator.Seed(Seed);
+	Ticks = 0;
+	Time = 0.0f;
+	SpawnTimer = 0.0f;
+	for(int i = 0; i < WallSlots; i++)
+		WallX[i] = BATCH_NO_WALL;
+
+	for(int i = 0; i < PaddedCount; i++) {
+		PlayerY[i] = 0.0f;
+		VelocityY[i] = 0.0f;
+		Living[i] = i < Count;
+		Death[i] = DEATH_NONE;
+		FinalTicks[i] = 0;
+		FinalTime[i] = 0.0f;
+	}
+	Alive = Count;
+}
+
+// Add a wall pair at the right edge of the screen, matching _Game::SpawnWall.
+// Slots are sized from the screen width, so one is always free.
+void _Population::SpawnWall() {
+	std::uniform_real_distribution<double> Distribution(ScreenHeight/2 - SPAWN_RANGE, ScreenHeight/2 + SPAWN_RANGE);
+	float MidY = (float)Distribution(RandomGenerator);
+	for(int i = 0; i < WallSlots; i++) {
+		if(WallX[i] != BATCH_NO_WALL)
+			continue;
+
+		float BottomTop = MidY + SPACING;
+		WallX[i] = (float)ScreenWidth;
+		WallTopBottom[i] = 0.0f + (int)(MidY - SPACING);
+		WallBottomTop[i] = BottomTop;
+		WallBottomBottom[i] = BottomTop + (int)(ScreenHeight - BottomTop);
+		return;
+	}
+}
+
+// Advance the game one tick with a jump flag per player, returning the number of players still alive
+int _Population::Step(const uint8_t *Jumps) {
+	if(!Alive)
+		return 0;
+
+	Ticks++;
+	Time += GAME_TIMESTEP;
+	SpawnTimer -= GAME_TIMESTEP;
+
+	// Scroll walls once for everyone, keeping the ones that reach the players' column.
+	// Players all share one X, so a wall's horizontal distance is the same for each of them,
+	// and a wall at least a radius away can't be hit whatever the vertical distance.
+	int NearCount = 0;
+	for(int i = 0; i < WallSlots; i++) {
+		if(WallX[i] == BATCH_NO_WALL)
+			continue;
+
+		float Left = WallX[i] + WALL_VELOCITY * GAME_TIMESTEP;
+		if(Left + (int)WALL_WIDTH < 0.0f) {
+			WallX[i] = BATCH_NO_WALL;
+			continue;
+		}
+		WallX[i] = Left;
+
+		float DistanceX = std::min(std::max(PLAYER_X, Left), Left + (int)WALL_WIDTH) - PLAYER_X;
+		if(DistanceX * DistanceX < PLAYER_RADIUS * PLAYER_RADIUS) {
+			NearDistanceXSquared[NearCount] = DistanceX * DistanceX;
+			NearSlots[NearCount++] = i;
+		}
+	}
+
+	// Fourth order Runge-Kutta under constant gravity, with the same operations as _Batch
+	const float HalfStep = GAME_TIMESTEP * 0.5f;
+	const float VelocityChange = (GRAVITY + (GRAVITY + GRAVITY) * 2.0f + GRAVITY) * (1.0f / 6.0f);
+	const __m128 Zero = _mm_setzero_ps();
+	const __m128 Two = _mm_set1_ps(2.0f);
+	const __m128 Sixth = _mm_set1_ps(1.0f / 6.0f);
+	const __m128 TimeStep = _mm_set1_ps(GAME_TIMESTEP);
+	const __m128 GravityHalfStep = _mm_set1_ps(GRAVITY * HalfStep);
+	const __m128 GravityStep = _mm_set1_ps(GRAVITY * GAME_TIMESTEP);
+	const __m128 VelocityStep = _mm_set1_ps(VelocityChange * GAME_TIMESTEP);
+	const __m128 JumpPower = _mm_set1_ps(JUMP_POWER);
+	const __m128 RadiusSquared = _mm_set1_ps(PLAYER_RADIUS * PLAYER_RADIUS);
+	const __m128 FallY = _mm_set1_ps(ScreenHeight + PLAYER_RADIUS);
+
+	for(int Index = 0; Index < PaddedCount; Index += _Batch::WIDTH) {
+
+		// Skip groups where every player is dead
+		uint32_t LivingGroup;
+		std::memcpy(&LivingGroup, &Living[Index], sizeof(LivingGroup));
+		if(!LivingGroup)
+			continue;
+
+		// Jump by replacing the velocity
+		float Flags[_Batch::WIDTH];
+		for(int i = 0; i < _Batch::WIDTH; i++)
+			Flags[i] = Index + i < Count && Jumps[Index + i];
+		__m128 JumpMask = _mm_cmpneq_ps(_mm_loadu_ps(Flags), Zero);
+		__m128 Velocity = _mm_loadu_ps(&VelocityY[Index]);
+		Velocity = _mm_or_ps(_mm_and_ps(JumpMask, JumpPower), _mm_andnot_ps(JumpMask, Velocity));
+
+		// Integrate and keep the player below the ceiling
+		__m128 Y = _mm_loadu_ps(&PlayerY[Index]);
+		__m128 Middle = _mm_add_ps(Velocity, GravityHalfStep);
+		__m128 Change = _mm_add_ps(Velocity, _mm_mul_ps(_mm_add_ps(Middle, Middle), Two));
+		Change = _mm_mul_ps(_mm_add_ps(Change, _mm_add_ps(Velocity, GravityStep)), Sixth);
+		Y = _mm_add_ps(Y, _mm_mul_ps(Change, TimeStep));
+		Y = _mm_max_ps(Y, Zero);
+		Velocity = _mm_add_ps(Velocity, VelocityStep);
+		_mm_storeu_ps(&PlayerY[Index], Y);
+		_mm_storeu_ps(&VelocityY[Index], Velocity);
+
+		// Test the circles against the near walls' top and bottom boxes
+		__m128 WallHit = Zero;
+		for(int i = 0; i < NearCount; i++) {
+			int Slot = NearSlots[i];
+			__m128 DistanceXSquared = _mm_set1_ps(NearDistanceXSquared[i]);
+			__m128 TopY = _mm_min_ps(Y, _mm_set1_ps(WallTopBottom[Slot]));
+			__m128 BottomY = _mm_min_ps(_mm_max_ps(Y, _mm_set1_ps(WallBottomTop[Slot])), _mm_set1_ps(WallBottomBottom[Slot]));
+			__m128 TopDistance = _mm_sub_ps(TopY, Y);
+			__m128 BottomDistance = _mm_sub_ps(BottomY, Y);
+			WallHit = _mm_or_ps(WallHit, _mm_cmplt_ps(_mm_add_ps(DistanceXSquared, _mm_mul_ps(TopDistance, TopDistance)), RadiusSquared));
+			WallHit = _mm_or_ps(WallHit, _mm_cmplt_ps(_mm_add_ps(DistanceXSquared, _mm_mul_ps(BottomDistance, BottomDistance)), RadiusSquared));
+		}
+
+		// Record deaths of players that were alive
+		int WallMask = _mm_movemask_ps(WallHit);
+		int FallMask = _mm_movemask_ps(_mm_cmpgt_ps(Y, FallY));
+		if(!(WallMask | FallMask))
+			continue;
+
+		for(int i = 0; i < _Batch::WIDTH; i++) {
+			int Player = Index + i;
+			if(!Living[Player] || !((WallMask | FallMask) & (1 << i)))
+				continue;
+
+			Living[Player] = 0;
+			Death[Player] = (WallMask & (1 << i)) ? DEATH_WALL : DEATH_FALL;
+			FinalTicks[Player] = Ticks;
+			FinalTime[Player] = Time;
+			Alive--;
+		}
+	}
+
+	// New walls start off to the right of every player
+	if(SpawnTimer <= 0.0f) {
+		SpawnWall();
+		SpawnTimer = SPAWNTIME;
+	}
+
+	return Alive;
+}
+
+// Decide jumps with the follow rule, each player jumping once it would fall within its margin of the gap's bottom
+void _Population::GetFollowJumps(const float *Margins, uint8_t *Jumps) const {
+	float GapX, GapY;
+	if(!GetNextGap(GapX, GapY))
+		GapY = ScreenHeight / 2;
+
+	float Bottom = GapY + SPACING - PLAYER_RADIUS;
+	for(int i = 0; i < Count; i++) {
+		float NextY = PlayerY[i] + (VelocityY[i] + GRAVITY * GAME_TIMESTEP) * GAME_TIMESTEP;
+		Jumps[i] = VelocityY[i] > 0.0f && NextY >= Bottom - Margins[i];
+	}
+}
+
+// Get the position of the nearest wall gap that the players haven't passed, matching _Game::GetNextGap
+bool _Population::GetNextGap(float &GapX, float &GapY) const {
+	float PlayerLeft = PLAYER_X - PLAYER_RADIUS;
+	bool Found = false;
+	for(int i = 0; i < WallSlots; i++) {
+		float X = WallX[i];
+		if(X == BATCH_NO_WALL || X + (int)WALL_WIDTH < PlayerLeft || (Found && X >= GapX))
+			continue;
+
+		GapX = X;
+		GapY = (WallTopBottom[i] + WallBottomTop[i]) * 0.5f;
+		Found = true;
+	}
+
+	return Found;
+}
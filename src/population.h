@@ -0,0 +1,82 @@
+/******************************************************************************
+* openflap
+* Copyright (C) 2014  Alan Witkowski
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*******************************************************************************/
+#pragma once
+
+// Libraries
+#include <batch.h>
+#include <stdint.h>
+#include <vector>
+
+// Many players flying through one game's walls, each with its own jumps.
+// The walls come from one seed and are shared, so each step moves them once and only tests
+// the players, four at a time, against the walls level with them. Players that die stay dead until Init.
+class _Population {
+
+	public:
+
+		_Population(int Count, int ScreenWidth, int ScreenHeight);
+
+		void Init(uint32_t Seed);
+		int Step(const uint8_t *Jumps);
+
+		void GetFollowJumps(const float *Margins, uint8_t *Jumps) const;
+		bool GetNextGap(float &GapX, float &GapY) const;
+		int GetCount() const { return Count; }
+		int GetAlive() const { return Alive; }
+		int GetWallSlots() const { return WallSlots; }
+
+		// Shared state
+		uint32_t Seed;
+		uint32_t Ticks;
+		float Time;
+		float SpawnTimer;
+
+		// Wall pairs, with unused slots far off screen
+		std::vector<float> WallX;
+		std::vector<float> WallTopBottom;
+		std::vector<float> WallBottomTop;
+		std::vector<float> WallBottomBottom;
+
+		// Player state
+		std::vector<float> PlayerY;
+		std::vector<float> VelocityY;
+		std::vector<uint8_t> Living;
+
+		// How each player's game ended, set on the step it died
+		std::vector<uint8_t> Death;
+		std::vector<uint32_t> FinalTicks;
+		std::vector<float> FinalTime;
+
+		// Attributes
+		int ScreenWidth, ScreenHeight;
+
+	private:
+
+		void SpawnWall();
+
+		int Count;
+		int PaddedCount;
+		int Alive;
+		int WallSlots;
+		_BatchRandom RandomGenerator;
+
+		// Walls level with the players in the current step
+		std::vector<float> NearDistanceXSquared;
+		std::vector<int> NearSlots;
+
+};
@@ -0,0 +1,146 @@
+/******************************************************************************
+* openflap
+* Copyright (C) 2014  Alan Witkowski
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*******************************************************************************/
+#include <raster.h>
+#include <game.h>
+#include <batch.h>
+#include <constants.h>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#ifdef __SSE2__
+	#include <emmintrin.h>
+#endif
+
+// Set a run of pixels to one shade, 16 at a time
+static inline void FillSpan(uint8_t *Row, int Begin, int End, uint8_t Shade) {
+#ifdef __SSE2__
+	__m128i Value = _mm_set1_epi8((char)Shade);
+	for(; Begin + 16 <= End; Begin += 16)
+		_mm_storeu_si128((__m128i *)(Row + Begin), Value);
+#endif
+	for(; Begin < End; Begin++)
+		Row[Begin] = Shade;
+}
+
+// Get the first pixel whose center is at or past a position
+static inline int GetPixel(float Position, float Scale, int Size) {
+	return std::min(std::max((int)std::ceil(Position * Scale - 0.5f), 0), Size);
+}
+
+// Constructor
+_Raster::_Raster(int Width, int Height, int ScreenWidth, int ScreenHeight) :
+	Width(Width),
+	Height(Height),
+	ScaleX((float)Width / ScreenWidth),
+	ScaleY((float)Height / ScreenHeight),
+	Rows(Height) {
+
+	// Shade each screen row from a new game's background layers
+	_Game Layout(ScreenWidth, ScreenHeight);
+	Layout.Init(0);
+	std::vector<int> ScreenRows(ScreenHeight, 0);
+	for(int i = 0; i < Layout.Backgrounds.GetCount(); i++) {
+		int Index = Layout.Backgrounds.GetIndex(i);
+		float Top = Layout.Backgrounds.Y[Index];
+		float Bottom = Top + Layout.Backgrounds.Height[Index];
+		int Height = Layout.Backgrounds.Height[Index];
+		if(Layout.Backgrounds.Texture[Index]) {
+			for(int Y = std::max((int)(Top + Height * RASTER_HILL_TOP), 0); Y < std::min((int)Bottom, ScreenHeight); Y++)
+				ScreenRows[Y] = RASTER_HILL_SHADE;
+		}
+		else {
+			for(int Y = std::max((int)Top, 0); Y < std::min((int)Bottom, ScreenHeight); Y++)
+				ScreenRows[Y] = RASTER_SKY_SHADES[(int)((Y - Top) * 8 / Height)];
+		}
+	}
+
+	// Average the screen rows under each row of the frame
+	for(int Y = 0; Y < Height; Y++) {
+		int Begin = Y * ScreenHeight / Height;
+		int End = std::max((Y + 1) * ScreenHeight / Height, Begin + 1);
+		int Sum = 0;
+		for(int i = Begin; i < End; i++)
+			Sum += ScreenRows[i];
+		Rows[Y] = (uint8_t)((Sum + (End - Begin) / 2) / (End - Begin));
+	}
+}
+
+// Draw a game into Width * Height pixels
+void _Raster::Draw(const _Game &Game, uint8_t *Pixels) const {
+	for(int Y = 0; Y < Height; Y++)
+		FillSpan(Pixels + Y * Width, 0, Width, Rows[Y]);
+
+	for(int i = 0; i < Game.Walls.GetCount(); i++) {
+		int Index = Game.Walls.GetIndex(i);
+		float X = Game.Walls.X[Index];
+		float Y = Game.Walls.Y[Index];
+		DrawWall(Pixels, X, Y, X + Game.Walls.Width[Index], Y + Game.Walls.Height[Index]);
+	}
+
+	const Vector2 &Position = Game.Player.Physics.GetPosition();
+	DrawCircle(Pixels, Position.X, Position.Y, Game.Player.Radius, RASTER_PLAYER_SHADE);
+}
+
+// Draw lanes Begin to End of a batch into consecutive frames
+void _Raster::Draw(const _Batch &Batch, int Begin, int End, uint8_t *Frames) const {
+	for(int Lane = Begin; Lane < End; Lane++) {
+		uint8_t *Pixels = Frames + (size_t)(Lane - Begin) * Width * Height;
+		for(int Y = 0; Y < Height; Y++)
+			FillSpan(Pixels + Y * Width, 0, Width, Rows[Y]);
+
+		for(int i = 0; i < Batch.GetWallSlots(); i++) {
+			float X = Batch.WallX[i][Lane];
+			if(X == BATCH_NO_WALL)
+				continue;
+
+			DrawWall(Pixels, X, 0.0f, X + WALL_WIDTH, Batch.WallTopBottom[i][Lane]);
+			DrawWall(Pixels, X, Batch.WallBottomTop[i][Lane], X + WALL_WIDTH, Batch.WallBottomBottom[i][Lane]);
+		}
+
+		DrawCircle(Pixels, PLAYER_X, Batch.PlayerY[Lane], PLAYER_RADIUS, RASTER_PLAYER_SHADE);
+	}
+}
+
+// Shade the pixels whose centers are inside a wall given in screen coordinates, with bands across it like the image.
+// Every row is the same, so the first is copied down.
+void _Raster::DrawWall(uint8_t *Pixels, float Left, float Top, float Right, float Bottom) const {
+	int Begin = GetPixel(Left, ScaleX, Width);
+	int End = GetPixel(Right, ScaleX, Width);
+	int Row = GetPixel(Top, ScaleY, Height);
+	int RowEnd = GetPixel(Bottom, ScaleY, Height);
+	if(Begin >= End || Row >= RowEnd)
+		return;
+
+	uint8_t *First = Pixels + Row * Width;
+	for(int X = Begin; X < End; X++) {
+		int Band = (int)(((X + 0.5f) / ScaleX - Left) * 8 / (Right - Left));
+		First[X] = (uint8_t)RASTER_WALL_SHADES[std::min(std::max(Band, 0), 7)];
+	}
+	for(Row++; Row < RowEnd; Row++)
+		std::memcpy(Pixels + Row * Width + Begin, First + Begin, End - Begin);
+}
+
+// Fill the pixels whose centers are inside a circle given in screen coordinates
+void _Raster::DrawCircle(uint8_t *Pixels, float X, float Y, float Radius, uint8_t Shade) const {
+	int RowEnd = GetPixel(Y + Radius, ScaleY, Height);
+	for(int Row = GetPixel(Y - Radius, ScaleY, Height); Row < RowEnd; Row++) {
+		float OffsetY = (Row + 0.5f) / ScaleY - Y;
+		float HalfWidth = std::sqrt(std::max(Radius * Radius - OffsetY * OffsetY, 0.0f));
+		FillSpan(Pixels + Row * Width, GetPixel(X - HalfWidth, ScaleX, Width), GetPixel(X + HalfWidth, ScaleX, Width), Shade);
+	}
+}
@@ -0,0 +1,53 @@
+/******************************************************************************
+* openflap
+* Copyright (C) 2014  Alan Witkowski
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*******************************************************************************/
+#pragma once
+
+// Libraries
+#include <stdint.h>
+#include <vector>
+
+// Forward declarations
+class _Game;
+class _Batch;
+
+// Draws small grayscale frames of games on the CPU, with bands of flat shades standing in for the images.
+// Background layers only change down the rows once flattened, so they're drawn as fixed rows.
+class _Raster {
+
+	public:
+
+		_Raster(int Width, int Height, int ScreenWidth, int ScreenHeight);
+
+		void Draw(const _Game &Game, uint8_t *Pixels) const;
+		void Draw(const _Batch &Batch, int Begin, int End, uint8_t *Frames) const;
+
+		int GetWidth() const { return Width; }
+		int GetHeight() const { return Height; }
+
+	private:
+
+		void DrawWall(uint8_t *Pixels, float Left, float Top, float Right, float Bottom) const;
+		void DrawCircle(uint8_t *Pixels, float X, float Y, float Radius, uint8_t Shade) const;
+
+		int Width, Height;
+		float ScaleX, ScaleY;
+
+		// Shade of each row of background, averaged over the screen rows it covers
+		std::vector<uint8_t> Rows;
+
+};
@@ -0,0 +1,163 @@
+/******************************************************************************
+* openflap
+* Copyright (C) 2014  Alan Witkowski
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*******************************************************************************/
+#include <render.h>
+#include <game.h>
+#include <population.h>
+#include <font.h>
+#include <framestats.h>
+#include <assets.h>
+#include <constants.h>
+
+const SDL_Color ColorWhite = { 255, 255, 255, 255 };
+const SDL_Color ColorRed = { 255, 0, 0, 255 };
+
+// Constructor
+_Render::_Render() :
+	Renderer(nullptr),
+	PlayerTexture(nullptr),
+	WallTexture(nullptr),
+	Font(nullptr),
+	HUDFont(nullptr),
+	ScreenWidth(0) {
+
+	BackTextures[0] = BackTextures[1] = nullptr;
+}
+
+// Destructor
+_Render::~_Render() {
+	delete HUDFont;
+	if(Font)
+		TTF_CloseFont(Font);
+
+	SDL_DestroyTexture(PlayerTexture);
+	SDL_DestroyTexture(WallTexture);
+	SDL_DestroyTexture(BackTextures[0]);
+	SDL_DestroyTexture(BackTextures[1]);
+}
+
+// Load fonts and upload decoded images
+bool _Render::Load(SDL_Renderer *Renderer, const _Assets &Assets) {
+	this->Renderer = Renderer;
+	if(SDL_GetRendererOutputSize(Renderer, &ScreenWidth, nullptr) != 0)
+		return false;
+
+	// Load fonts
+	Font = TTF_OpenFontRW(Assets.OpenFile("font/arimo_regular.ttf"), 1, 18);
+	if(Font == nullptr)
+		return false;
+
+	// Build glyph atlas
+	HUDFont = new _Font();
+	if(!HUDFont->Load(Renderer, Font))
+		return false;
+
+	// Create textures
+	PlayerTexture = SDL_CreateTextureFromSurface(Renderer, Assets.Images[IMAGE_PLAYER]);
+	WallTexture = SDL_CreateTextureFromSurface(Renderer, Assets.Images[IMAGE_WALL]);
+	BackTextures[0] = SDL_CreateTextureFromSurface(Renderer, Assets.Images[IMAGE_BACK0]);
+	BackTextures[1] = SDL_CreateTextureFromSurface(Renderer, Assets.Images[IMAGE_BACK1]);
+
+	return PlayerTexture && WallTexture && BackTextures[0] && BackTextures[1];
+}
+
+// Draw objects without presenting
+void _Render::Draw(const _Game &Game, float HighScore, float Blend, const _Population *Ghosts) {
+
+	// Clear screen
+	SDL_RenderClear(Renderer);
+
+	// Draw backgrounds
+	DrawSprites(Game.Backgrounds, BackTextures, Blend);
+
+	// Draw walls
+	DrawSprites(Game.Walls, &WallTexture, Blend);
+
+	// Draw ghosts behind the player
+	if(Ghosts)
+		DrawGhosts(*Ghosts, Blend);
+
+	// Draw player
+	DrawSprite(PlayerTexture, Game.Player.Physics.GetPosition(), Game.Player.Physics.GetLastPosition(), 64, 64, -32, -32, Blend);
+
+	// Draw stats
+	HUDFont->DrawText(VersionText.GetText(), ScreenWidth - 160, 15, ColorWhite);
+	HUDFont->DrawText(SeedText.GetText(), ScreenWidth - 160, 35, ColorWhite);
+
+	_TextBuffer Buffer;
+	Buffer.Append("Time: ").Append(Game.Time, 2);
+	HUDFont->DrawText(Buffer.GetText(), ScreenWidth - 160, 75, ColorWhite);
+
+	Buffer.Clear();
+	Buffer.Append("High Score: ").Append(HighScore, 2);
+	HUDFont->DrawText(Buffer.GetText(), ScreenWidth - 160, 95, ColorWhite);
+
+	// Draw death message
+	if(Game.State == STATE_DIED)
+		HUDFont->DrawText("You Died!", 10, 10, ColorRed);
+}
+
+// Draw p50/p99/max milliseconds for each phase of the main loop
+void _Render::DrawFrameStats(const _FrameStats &FrameStats) {
+	int Y = 40;
+	for(int i = 0; i < PHASE_COUNT; i++) {
+		const _Histogram &Histogram = FrameStats.GetHistogram(i);
+
+		_TextBuffer Buffer;
+		Buffer.Append(_FrameStats::GetPhaseName(i)).Append(": ");
+		Buffer.Append(Histogram.GetPercentile(50.0) / 1000.0f, 2).Append(" / ");
+		Buffer.Append(Histogram.GetPercentile(99.0) / 1000.0f, 2).Append(" / ");
+		Buffer.Append(Histogram.GetMax() / 1000.0f, 2).Append(" ms");
+		HUDFont->DrawText(Buffer.GetText(), 10, Y, ColorWhite);
+		Y += HUDFont->GetHeight();
+	}
+}
+
+// Draw texture at the position interpolated between the last two physics states
+void _Render::DrawSprite(SDL_Texture *Texture, const Vector2 &Position, const Vector2 &LastPosition, int Width, int Height, int OffsetX, int OffsetY, float Blend) {
+	SDL_Rect Bounds;
+	Bounds.x = (int)(Position.X * Blend + LastPosition.X * (1.0f - Blend) + 0.5f) + OffsetX;
+	Bounds.y = (int)(Position.Y * Blend + LastPosition.Y * (1.0f - Blend) + 0.5f) + OffsetY;
+	Bounds.w = Width;
+	Bounds.h = Height;
+
+	SDL_RenderCopy(Renderer, Texture, nullptr, &Bounds);
+}
+
+// Draw scrolling sprites using their texture index
+void _Render::DrawSprites(const _SpriteBuffer &Sprites, SDL_Texture **Textures, float Blend) {
+	for(int i = 0; i < Sprites.GetCount(); i++) {
+		int Index = Sprites.GetIndex(i);
+		Vector2 Position(Sprites.X[Index], Sprites.Y[Index]);
+		Vector2 LastPosition(Sprites.LastX[Index], Sprites.Y[Index]);
+		DrawSprite(Textures[Sprites.Texture[Index]], Position, LastPosition, Sprites.Width[Index], Sprites.Height[Index], 0, 0, Blend);
+	}
+}
+
+// Draw the living ghosts faintly, estimating their last positions from their velocities
+void _Render::DrawGhosts(const _Population &Ghosts, float Blend) {
+	SDL_SetTextureAlphaMod(PlayerTexture, GHOST_ALPHA);
+	for(int i = 0; i < Ghosts.GetCount(); i++) {
+		if(!Ghosts.Living[i])
+			continue;
+
+		Vector2 Position(PLAYER_X, Ghosts.PlayerY[i]);
+		Vector2 LastPosition(PLAYER_X, Ghosts.PlayerY[i] - Ghosts.VelocityY[i] * GAME_TIMESTEP);
+		DrawSprite(PlayerTexture, Position, LastPosition, 64, 64, -32, -32, Blend);
+	}
+	SDL_SetTextureAlphaMod(PlayerTexture, 255);
+}
@@ -0,0 +1,64 @@
+/******************************************************************************
+* openflap
+* Copyright (C) 2014  Alan Witkowski
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*******************************************************************************/
+#pragma once
+
+// Libraries
+#include <SDL.h>
+#include <SDL_ttf.h>
+#include <textbuffer.h>
+#include <vector2.h>
+
+// Forward declarations
+class _Game;
+class _Population;
+class _Font;
+class _SpriteBuffer;
+class _FrameStats;
+class _Assets;
+
+// Draws the game and HUD with an SDL renderer
+class _Render {
+
+	public:
+
+		_Render();
+		~_Render();
+
+		bool Load(SDL_Renderer *Renderer, const _Assets &Assets);
+		void Draw(const _Game &Game, float HighScore, float Blend, const _Population *Ghosts=nullptr);
+		void DrawFrameStats(const _FrameStats &FrameStats);
+
+		// Attributes
+		_TextBuffer VersionText;
+		_TextBuffer SeedText;
+
+	private:
+
+		void DrawSprite(SDL_Texture *Texture, const Vector2 &Position, const Vector2 &LastPosition, int Width, int Height, int OffsetX, int OffsetY, float Blend);
+		void DrawSprites(const _SpriteBuffer &Sprites, SDL_Texture **Textures, float Blend);
+		void DrawGhosts(const _Population &Ghosts, float Blend);
+
+		SDL_Renderer *Renderer;
+		SDL_Texture *PlayerTexture;
+		SDL_Texture *WallTexture;
+		SDL_Texture *BackTextures[2];
+		TTF_Font *Font;
+		_Font *HUDFont;
+		int ScreenWidth;
+
+};
@@ -0,0 +1,256 @@
+/******************************************************************************
+* openflap
+* Copyright (C) 2014  Alan Witkowski
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*******************************************************************************/
+#include <replay.h>
+#include <game.h>
+#include <constants.h>
+#include <fstream>
+#include <algorithm>
+#include <iterator>
+#include <cstring>
+
+// File layout:
+//   "OFRP", format version byte, game version length byte and characters,
+//   seed, ticks and score bits as little-endian 32-bit values,
+//   screen size, jump count and the gaps between jump ticks as LEB128 varints.
+//   Since format 2 each gap is followed by a byte holding the jump's offset
+//   into its tick in 1/INPUT_SUBTICKS steps.
+static const char REPLAY_MAGIC[4] = { 'O', 'F', 'R', 'P' };
+static const uint8_t REPLAY_FORMAT = 2;
+
+// Game time is a float sum of timesteps that falls behind the tick count on long runs,
+// so allow this much more than the claimed score's ticks, plus a fixed number of ticks
+static const double REPLAY_TICK_MARGIN = 1.5;
+static const double REPLAY_TICK_SLACK = 100.0;
+
+// Write little-endian 32-bit value
+static void WriteUInt32(std::vector<uint8_t> &Data, uint32_t Value) {
+	for(int i = 0; i < 4; i++)
+		Data.push_back((uint8_t)(Value >> (i * 8)));
+}
+
+// Write variable length value
+static void WriteVarint(std::vector<uint8_t> &Data, uint32_t Value) {
+	while(Value >= 0x80) {
+		Data.push_back((uint8_t)(Value | 0x80));
+		Value >>= 7;
+	}
+	Data.push_back((uint8_t)Value);
+}
+
+// Read little-endian 32-bit value
+static bool ReadUInt32(const uint8_t *&Data, const uint8_t *End, uint32_t &Value) {
+	if(End - Data < 4)
+		return false;
+
+	Value = (uint32_t)Data[0] | ((uint32_t)Data[1] << 8) | ((uint32_t)Data[2] << 16) | ((uint32_t)Data[3] << 24);
+	Data += 4;
+
+	return true;
+}
+
+// Read variable length value
+static bool ReadVarint(const uint8_t *&Data, const uint8_t *End, uint32_t &Value) {
+	Value = 0;
+	for(int Shift = 0; Shift < 35; Shift += 7) {
+		if(Data == End)
+			return false;
+
+		uint8_t Byte = *Data++;
+		Value |= (uint32_t)(Byte & 0x7F) << Shift;
+		if(!(Byte & 0x80))
+			return true;
+	}
+
+	return false;
+}
+
+// Begin recording a new run
+void _Replay::Start(const _Game &Game) {
+	Version = GAME_VERSION;
+	Seed = Game.Seed;
+	ScreenWidth = (uint32_t)Game.ScreenWidth;
+	ScreenHeight = (uint32_t)Game.ScreenHeight;
+	Ticks = 0;
+	Score = 0.0f;
+	Jumps.clear();
+	JumpOffsets.clear();
+}
+
+// Store the result of the run
+void _Replay::Finish(const _Game &Game) {
+	Ticks = Game.Ticks;
+	Score = Game.Time;
+}
+
+// Serialize replay
+void _Replay::Encode(std::vector<uint8_t> &Data) const {
+	Data.clear();
+	for(int i = 0; i < 4; i++)
+		Data.push_back((uint8_t)REPLAY_MAGIC[i]);
+	Data.push_back(REPLAY_FORMAT);
+
+	size_t VersionLength = Version.size() > 255 ? 255 : Version.size();
+	Data.push_back((uint8_t)VersionLength);
+	for(size_t i = 0; i < VersionLength; i++)
+		Data.push_back((uint8_t)Version[i]);
+
+	uint32_t ScoreBits;
+	memcpy(&ScoreBits, &Score, sizeof(ScoreBits));
+	WriteUInt32(Data, Seed);
+	WriteUInt32(Data, Ticks);
+	WriteUInt32(Data, ScoreBits);
+	WriteVarint(Data, ScreenWidth);
+	WriteVarint(Data, ScreenHeight);
+
+	WriteVarint(Data, (uint32_t)Jumps.size());
+	uint32_t LastTick = 0;
+	for(size_t i = 0; i < Jumps.size(); i++) {
+		WriteVarint(Data, Jumps[i] - LastTick);
+		Data.push_back(JumpOffsets[i]);
+		LastTick = Jumps[i];
+	}
+}
+
+// Deserialize replay
+bool _Replay::Decode(const uint8_t *Data, size_t Size) {
+	const uint8_t *End = Data + Size;
+	if(Size < 6 || memcmp(Data, REPLAY_MAGIC, 4) != 0 || Data[4] < 1 || Data[4] > REPLAY_FORMAT)
+		return false;
+	bool HasOffsets = Data[4] >= 2;
+	Data += 5;
+
+	// Read game version
+	size_t VersionLength = *Data++;
+	if((size_t)(End - Data) < VersionLength)
+		return false;
+	Version.assign((const char *)Data, VersionLength);
+	Data += VersionLength;
+
+	// Read header
+	uint32_t ScoreBits;
+	if(!ReadUInt32(Data, End, Seed) || !ReadUInt32(Data, End, Ticks) || !ReadUInt32(Data, End, ScoreBits))
+		return false;
+	memcpy(&Score, &ScoreBits, sizeof(Score));
+	if(!ReadVarint(Data, End, ScreenWidth) || !ReadVarint(Data, End, ScreenHeight))
+		return false;
+
+	// Read jump ticks
+	uint32_t Count;
+	if(!ReadVarint(Data, End, Count) || Count > (uint32_t)(End - Data))
+		return false;
+
+	Jumps.resize(Count);
+	JumpOffsets.assign(Count, 0);
+	uint32_t Tick = 0;
+	for(uint32_t i = 0; i < Count; i++) {
+		uint32_t Delta;
+		if(!ReadVarint(Data, End, Delta))
+			return false;
+
+		if(HasOffsets) {
+			if(Data == End)
+				return false;
+			JumpOffsets[i] = *Data++;
+		}
+
+		Tick += Delta;
+		Jumps[i] = Tick;
+	}
+
+	return Data == End;
+}
+
+// Write replay file
+bool _Replay::Save(const std::string &Path) const {
+	std::vector<uint8_t> Data;
+	Encode(Data);
+
+	std::ofstream File(Path.c_str(), std::ios::binary);
+	if(!File.is_open())
+		return false;
+
+	File.write((const char *)Data.data(), Data.size());
+
+	return File.good();
+}
+
+// Read replay file
+bool _Replay::Load(const std::string &Path) {
+	std::ifstream File(Path.c_str(), std::ios::binary);
+	if(!File.is_open())
+		return false;
+
+	std::vector<uint8_t> Data((std::istreambuf_iterator<char>(File)), std::istreambuf_iterator<char>());
+
+	return Decode(Data.data(), Data.size());
+}
+
+// Check if the player jumps on the given tick, advancing the cursor past it
+bool _Replay::GetJump(uint32_t Tick, size_t &Cursor, uint8_t &Offset) const {
+	while(Cursor < Jumps.size() && Jumps[Cursor] < Tick)
+		Cursor++;
+
+	if(Cursor < Jumps.size() && Jumps[Cursor] == Tick) {
+		Offset = JumpOffsets[Cursor];
+		Cursor++;
+		return true;
+	}
+
+	return false;
+}
+
+// Check that the run was recorded on the screen size replays are verified with
+bool _Replay::HasDefaultGeometry() const {
+	return ScreenWidth == (uint32_t)DEFAULT_SCREEN_WIDTH && ScreenHeight == (uint32_t)DEFAULT_SCREEN_HEIGHT;
+}
+
+// Get the most ticks a run with the claimed score could have lasted
+uint32_t _Replay::GetTickLimit() const {
+	double Limit = REPLAY_TICK_SLACK;
+	if(Score > 0.0f)
+		Limit += (double)Score * GAME_FPS * REPLAY_TICK_MARGIN;
+
+	return Limit < (double)UINT32_MAX ? (uint32_t)Limit : UINT32_MAX;
+}
+
+// Simulate the run without rendering, stopping at death or the recorded tick count.
+// Returns false without playing if the run wasn't recorded on the default screen size.
+bool _Replay::Play(_Game &Game) const {
+	if(!HasDefaultGeometry())
+		return false;
+
+	Game.ScreenWidth = DEFAULT_SCREEN_WIDTH;
+	Game.ScreenHeight = DEFAULT_SCREEN_HEIGHT;
+	Game.Init(Seed);
+
+	// Don't trust the recorded tick count further than the score allows
+	uint32_t Limit = std::min(Ticks, GetTickLimit());
+	size_t Cursor = 0;
+	while(Game.State == STATE_PLAY && Game.Ticks < Limit) {
+		_Input Input;
+		Input.Jump = GetJump(Game.Ticks, Cursor, Input.JumpOffset);
+		Game.Step(Input);
+	}
+
+	return true;
+}
+
+// Simulate the run and check that it dies with the recorded ticks and score
+bool _Replay::Verify(_Game &Game) const {
+	return Play(Game) && Game.State == STATE_DIED && Game.Ticks == Ticks && Game.Time == Score;
+}
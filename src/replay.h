@@ -0,0 +1,60 @@
+/******************************************************************************
+* openflap
+* Copyright (C) 2014  Alan Witkowski
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*******************************************************************************/
+#pragma once
+
+// Libraries
+#include <stdint.h>
+#include <stddef.h>
+#include <string>
+#include <vector>
+
+// Forward declarations
+class _Game;
+
+// Recorded run stored as a seed and the ticks on which the player jumped, with the sub-tick offset of each jump
+class _Replay {
+
+	public:
+
+		_Replay() : Seed(0), ScreenWidth(0), ScreenHeight(0), Ticks(0), Score(0.0f) { }
+
+		void Start(const _Game &Game);
+		void RecordJump(uint32_t Tick, uint8_t Offset) { Jumps.push_back(Tick); JumpOffsets.push_back(Offset); }
+		void Finish(const _Game &Game);
+
+		bool Save(const std::string &Path) const;
+		bool Load(const std::string &Path);
+		bool Decode(const uint8_t *Data, size_t Size);
+		void Encode(std::vector<uint8_t> &Data) const;
+
+		bool GetJump(uint32_t Tick, size_t &Cursor, uint8_t &Offset) const;
+		bool HasDefaultGeometry() const;
+		uint32_t GetTickLimit() const;
+		bool Play(_Game &Game) const;
+		bool Verify(_Game &Game) const;
+
+		// State
+		std::string Version;
+		uint32_t Seed;
+		uint32_t ScreenWidth, ScreenHeight;
+		uint32_t Ticks;
+		float Score;
+		std::vector<uint32_t> Jumps;
+		std::vector<uint8_t> JumpOffsets;
+
+};
@@ -0,0 +1,499 @@
+/******************************************************************************
+* openflap
+* Copyright (C) 2014  Alan Witkowski
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*******************************************************************************/
+#include <serve.h>
+#include <batch.h>
+#include <constants.h>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <thread>
+#include <xmmintrin.h>
+#ifdef __linux__
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <sys/file.h>
+	#include <sys/syscall.h>
+	#include <linux/futex.h>
+	#include <fcntl.h>
+	#include <unistd.h>
+	#include <signal.h>
+	#include <cerrno>
+	#include <climits>
+	#include <ctime>
+#endif
+
+const uint32_t SERVE_MAGIC = 0x5653464f;
+const uint32_t SERVE_VERSION = 2;
+
+// Checks of the sequence number before sleeping, the first few with a pause and the rest yielding
+const int SERVE_PAUSE_COUNT = 64;
+const int SERVE_SPIN_COUNT = 4096;
+
+// Times Create looks at existing shared memory that another server hasn't finished creating,
+// a millisecond apart, before taking it as left by a server that died while creating it
+const int SERVE_CREATE_ATTEMPTS = 100;
+
+static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t), "Futex words must be plain 32-bit integers");
+
+// Start of the shared memory, with each side's sequence number on its own cache line
+struct _ServeHeader {
+	uint32_t Magic;
+	uint32_t Version;
+	uint32_t EnvCount;
+	uint32_t ObservationSize;
+
+	// Processes on each side, with no client while zero
+	std::atomic<int32_t> ServerPid;
+	std::atomic<int32_t> ClientPid;
+
+	// Client to server
+	alignas(64) std::atomic<uint32_t> Request;
+	std::atomic<uint32_t> ServerSleeping;
+	uint32_t Command;
+
+	// Server to client
+	alignas(64) std::atomic<uint32_t> Response;
+	std::atomic<uint32_t> ClientSleeping;
+	uint32_t Ended;
+};
+
+// Round up to a cache line
+static size_t Align(size_t Offset) {
+	return (Offset + 63) & ~(size_t)63;
+}
+
+#ifdef __linux__
+
+// Check that a process exists, even if it belongs to another user
+static bool IsAlive(int32_t Pid) {
+	return Pid > 0 && (kill(Pid, 0) == 0 || errno == EPERM);
+}
+
+// Wait until a sequence number moves on from a value, spinning first and then sleeping.
+// Returns false if the other side's process exits first.
+static bool WaitChange(std::atomic<uint32_t> &Sequence, uint32_t Value, std::atomic<uint32_t> &Sleeping, const std::atomic<int32_t> &Peer) {
+	for(int i = 0; i < SERVE_SPIN_COUNT; i++) {
+		if(Sequence.load(std::memory_order_acquire) != Value)
+			return true;
+
+		if(i < SERVE_PAUSE_COUNT)
+			_mm_pause();
+		else
+			std::this_thread::yield();
+	}
+
+	// Wake up now and then to check the other side hasn't exited without posting
+	timespec Timeout = { 0, 100000000 };
+	while(Sequence.load() == Value) {
+		Sleeping.store(1);
+		if(Sequence.load() == Value)
+			syscall(SYS_futex, reinterpret_cast<uint32_t *>(&Sequence), FUTEX_WAIT, Value, &Timeout, nullptr, 0);
+		Sleeping.store(0);
+
+		int32_t Pid = Peer.load();
+		if(Sequence.load() == Value && Pid && !IsAlive(Pid))
+			return false;
+	}
+
+	return true;
+}
+
+// Move a sequence number on and wake the other side if it's asleep
+static void Post(std::atomic<uint32_t> &Sequence, std::atomic<uint32_t> &Sleeping) {
+	Sequence.fetch_add(1);
+	if(Sleeping.load())
+		syscall(SYS_futex, reinterpret_cast<uint32_t *>(&Sequence), FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+}
+
+#else
+
+static bool WaitChange(std::atomic<uint32_t> &Sequence, uint32_t Value, std::atomic<uint32_t> &Sleeping, const std::atomic<int32_t> &Peer) {
+	while(Sequence.load(std::memory_order_acquire) == Value)
+		std::this_thread::yield();
+
+	return true;
+}
+
+static void Post(std::atomic<uint32_t> &Sequence, std::atomic<uint32_t> &Sleeping) {
+	Sequence.fetch_add(1);
+}
+
+#endif
+
+// Shared memory names start with a slash
+static std::string GetSharedName(const std::string &Name) {
+	return Name.size() && Name[0] == '/' ? Name : "/" + Name;
+}
+
+// Arrays after the header, in order
+enum ServeArrayType {
+	SERVE_SEEDS,
+	SERVE_ACTIONS,
+	SERVE_OBSERVATIONS,
+	SERVE_REWARDS,
+	SERVE_DONES,
+	SERVE_SCORES,
+	SERVE_TICKS,
+	SERVE_DEATHS,
+	SERVE_ARRAY_COUNT,
+};
+
+// Get the offset of each array and the total size of the shared memory
+static size_t GetLayout(int EnvCount, size_t *Offsets) {
+	const size_t ElementSizes[SERVE_ARRAY_COUNT] = {
+		sizeof(uint32_t),
+		sizeof(uint8_t),
+		_Batch::OBSERVATION_SIZE * sizeof(float),
+		sizeof(float),
+		sizeof(uint8_t),
+		sizeof(float),
+		sizeof(uint32_t),
+		sizeof(uint8_t),
+	};
+
+	size_t Offset = Align(sizeof(_ServeHeader));
+	for(int i = 0; i < SERVE_ARRAY_COUNT; i++) {
+		Offsets[i] = Offset;
+		Offset = Align(Offset + EnvCount * ElementSizes[i]);
+	}
+
+	return Offset;
+}
+
+// Constructor
+_ServeChannel::_ServeChannel() :
+	Seeds(nullptr),
+	Actions(nullptr),
+	Observations(nullptr),
+	Rewards(nullptr),
+	Dones(nullptr),
+	Scores(nullptr),
+	Ticks(nullptr),
+	Deaths(nullptr),
+	Header(nullptr),
+	Size(0),
+	Owner(false),
+	Client(false) {
+}
+
+// Destructor
+_ServeChannel::~_ServeChannel() {
+	Close();
+}
+
+#ifdef __linux__
+
+// What Create found under a name that was already taken
+enum ServeSegmentType {
+	SERVE_SEGMENT_SERVING,
+	SERVE_SEGMENT_CREATING,
+	SERVE_SEGMENT_REMOVED,
+};
+
+// Look at existing shared memory while holding its lock, which a server keeps from creating it until it's ready,
+// and remove it if the server that made it is gone
+static ServeSegmentType CheckSegment(const std::string &Name, bool Waited) {
+	int File = shm_open(Name.c_str(), O_RDONLY, 0);
+	if(File < 0)
+		return SERVE_SEGMENT_REMOVED;
+
+	// Make sure the name wasn't replaced while waiting for the lock
+	struct stat Stat, Current;
+	int CurrentFile = -1;
+	bool Same = flock(File, LOCK_EX) == 0 && fstat(File, &Stat) == 0 && (CurrentFile = shm_open(Name.c_str(), O_RDONLY, 0)) >= 0;
+	Same = Same && fstat(CurrentFile, &Current) == 0 && Stat.st_ino == Current.st_ino;
+	if(CurrentFile >= 0)
+		close(CurrentFile);
+	if(!Same) {
+		close(File);
+		return SERVE_SEGMENT_REMOVED;
+	}
+
+	// A server that has only just created it hasn't sized it or written its process ID yet
+	ServeSegmentType Segment = SERVE_SEGMENT_REMOVED;
+	void *Data = MAP_FAILED;
+	if((size_t)Stat.st_size >= sizeof(_ServeHeader))
+		Data = mmap(nullptr, sizeof(_ServeHeader), PROT_READ, MAP_SHARED, File, 0);
+	if(Data != MAP_FAILED) {
+		const _ServeHeader *Existing = (const _ServeHeader *)Data;
+		int32_t Pid = Existing->ServerPid.load();
+		bool Known = Existing->Magic == 0 || (Existing->Magic == SERVE_MAGIC && Existing->Version == SERVE_VERSION);
+		if(!Pid)
+			Segment = SERVE_SEGMENT_CREATING;
+		else if(Known && IsAlive(Pid))
+			Segment = SERVE_SEGMENT_SERVING;
+		munmap(Data, sizeof(_ServeHeader));
+	}
+	else
+		Segment = SERVE_SEGMENT_CREATING;
+
+	if(Segment == SERVE_SEGMENT_CREATING && Waited)
+		Segment = SERVE_SEGMENT_REMOVED;
+	if(Segment == SERVE_SEGMENT_REMOVED)
+		shm_unlink(Name.c_str());
+	close(File);
+
+	return Segment;
+}
+
+#endif
+
+// Create the shared memory for a server, replacing any left behind by a server that didn't exit cleanly
+bool _ServeChannel::Create(const std::string &Name, int EnvCount) {
+	Close();
+
+#ifdef __linux__
+	if(EnvCount <= 0)
+		return false;
+
+	// Take the name, waiting for a server that's still creating it and replacing one left by a dead server
+	this->Name = GetSharedName(Name);
+	int File;
+	for(int Attempt = 0; ; Attempt++) {
+		File = shm_open(this->Name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+		if(File >= 0 || errno != EEXIST)
+			break;
+
+		ServeSegmentType Segment = CheckSegment(this->Name, Attempt >= SERVE_CREATE_ATTEMPTS);
+		if(Segment == SERVE_SEGMENT_SERVING)
+			return false;
+		if(Segment == SERVE_SEGMENT_CREATING)
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+	if(File < 0)
+		return false;
+
+	// Hold the lock until the header is written
+	Owner = true;
+	size_t Offsets[SERVE_ARRAY_COUNT];
+	size_t NewSize = GetLayout(EnvCount, Offsets);
+	if(flock(File, LOCK_EX) != 0 || ftruncate(File, (off_t)NewSize) != 0 || !Map(File, NewSize)) {
+		close(File);
+		Close();
+		return false;
+	}
+
+	SetArrays(Offsets);
+	Header->ServerPid = (int32_t)getpid();
+	Header->Version = SERVE_VERSION;
+	Header->EnvCount = (uint32_t)EnvCount;
+	Header->ObservationSize = _Batch::OBSERVATION_SIZE;
+
+	// Clients check the magic number last
+	std::atomic_thread_fence(std::memory_order_release);
+	Header->Magic = SERVE_MAGIC;
+
+	// The mapping keeps the file open, so unlock it explicitly
+	flock(File, LOCK_UN);
+	close(File);
+
+	return true;
+#else
+	return false;
+#endif
+}
+
+// Open a server's shared memory as a client
+bool _ServeChannel::Open(const std::string &Name) {
+	Close();
+
+#ifdef __linux__
+	this->Name = GetSharedName(Name);
+	int File = shm_open(this->Name.c_str(), O_RDWR, 0);
+	if(File < 0)
+		return false;
+
+	struct stat Stat;
+	if(fstat(File, &Stat) != 0 || (size_t)Stat.st_size < sizeof(_ServeHeader) || !Map(File, (size_t)Stat.st_size)) {
+		close(File);
+		Close();
+		return false;
+	}
+	close(File);
+
+	if(Header->Magic != SERVE_MAGIC || Header->Version != SERVE_VERSION || Header->ObservationSize != _Batch::OBSERVATION_SIZE) {
+		Close();
+		return false;
+	}
+	std::atomic_thread_fence(std::memory_order_acquire);
+
+	size_t Offsets[SERVE_ARRAY_COUNT];
+	if(GetLayout((int)Header->EnvCount, Offsets) > Size) {
+		Close();
+		return false;
+	}
+
+	// Take the client's place unless another running client has it
+	int32_t Pid = Header->ClientPid.load();
+	if((Pid && IsAlive(Pid)) || !Header->ClientPid.compare_exchange_strong(Pid, (int32_t)getpid())) {
+		Close();
+		return false;
+	}
+	Client = true;
+	SetArrays(Offsets);
+
+	return true;
+#else
+	return false;
+#endif
+}
+
+// Map an open shared memory file
+bool _ServeChannel::Map(int File, size_t Size) {
+#ifdef __linux__
+	void *Data = mmap(nullptr, Size, PROT_READ | PROT_WRITE, MAP_SHARED, File, 0);
+	if(Data == MAP_FAILED)
+		return false;
+
+	Header = (_ServeHeader *)Data;
+	this->Size = Size;
+	return true;
+#else
+	return false;
+#endif
+}
+
+// Point the arrays into the shared memory
+void _ServeChannel::SetArrays(const size_t *Offsets) {
+	uint8_t *Base = (uint8_t *)Header;
+	Seeds = (uint32_t *)(Base + Offsets[SERVE_SEEDS]);
+	Actions = Base + Offsets[SERVE_ACTIONS];
+	Observations = (float *)(Base + Offsets[SERVE_OBSERVATIONS]);
+	Rewards = (float *)(Base + Offsets[SERVE_REWARDS]);
+	Dones = Base + Offsets[SERVE_DONES];
+	Scores = (float *)(Base + Offsets[SERVE_SCORES]);
+	Ticks = (uint32_t *)(Base + Offsets[SERVE_TICKS]);
+	Deaths = Base + Offsets[SERVE_DEATHS];
+}
+
+// Unmap, leaving the client's place free or removing the shared memory if this side created it
+void _ServeChannel::Close() {
+#ifdef __linux__
+	if(Header && Client) {
+		int32_t Pid = (int32_t)getpid();
+		Header->ClientPid.compare_exchange_strong(Pid, 0);
+	}
+	if(Header)
+		munmap(Header, Size);
+	if(Owner)
+		shm_unlink(Name.c_str());
+#endif
+
+	Header = nullptr;
+	Size = 0;
+	Owner = false;
+	Client = false;
+	Seeds = nullptr;
+	Actions = Dones = Deaths = nullptr;
+	Observations = Rewards = Scores = nullptr;
+	Ticks = nullptr;
+}
+
+// Send a request and wait for the server to finish it, returning false if the server exited
+bool _ServeChannel::Call(ServeCommandType Command) {
+	uint32_t Response = Header->Response.load();
+	Header->Command = Command;
+	Post(Header->Request, Header->ServerSleeping);
+	return WaitChange(Header->Response, Response, Header->ClientSleeping, Header->ServerPid);
+}
+
+// Wait for the next request, returning false if the client exited without quitting
+bool _ServeChannel::WaitRequest(ServeCommandType &Command) {
+	if(!WaitChange(Header->Request, Header->Response.load(), Header->ServerSleeping, Header->ClientPid))
+		return false;
+
+	Command = (ServeCommandType)Header->Command;
+	return true;
+}
+
+// Finish the current request
+void _ServeChannel::Respond(int Ended) {
+	Header->Ended = (uint32_t)Ended;
+	Post(Header->Response, Header->ClientSleeping);
+}
+
+// Number of games
+int _ServeChannel::GetEnvCount() const {
+	return (int)Header->EnvCount;
+}
+
+// Number of games that ended in the last step
+int _ServeChannel::GetEnded() const {
+	return (int)Header->Ended;
+}
+
+// Step games for a client until it asks to quit
+int RunServe(const std::string &Name, int EnvCount, bool Quiet) {
+	_ServeChannel Channel;
+	if(!Channel.Create(Name, EnvCount)) {
+		std::cout << "Cannot create shared memory, or another server is using it: " << Name << std::endl;
+		return 1;
+	}
+
+	_Batch Batch(EnvCount, DEFAULT_SCREEN_WIDTH, DEFAULT_SCREEN_HEIGHT);
+	for(int i = 0; i < EnvCount; i++)
+		Channel.Seeds[i] = i;
+	Batch.InitLanes(Channel.Seeds);
+	Batch.GetObservations(Channel.Observations);
+	if(!Quiet)
+		std::cout << "Serving " << EnvCount << " games on " << GetSharedName(Name) << std::endl;
+
+	uint64_t Steps = 0;
+	uint64_t Games = 0;
+	for(;;) {
+		ServeCommandType Command;
+		if(!Channel.WaitRequest(Command)) {
+			std::cout << "Client exited without quitting" << std::endl;
+			return 1;
+		}
+		if(Command == SERVE_QUIT) {
+			Channel.Respond(0);
+			break;
+		}
+
+		int Ended = 0;
+		if(Command == SERVE_RESET) {
+			Batch.InitLanes(Channel.Seeds);
+			for(int i = 0; i < EnvCount; i++) {
+				Channel.Rewards[i] = 0.0f;
+				Channel.Dones[i] = 0;
+			}
+		}
+		else {
+			Ended = Batch.Step(Channel.Actions);
+			for(int i = 0; i < EnvCount; i++) {
+				Channel.Rewards[i] = GAME_TIMESTEP;
+				Channel.Dones[i] = Batch.Done[i];
+				if(Batch.Done[i]) {
+					Channel.Scores[i] = Batch.FinalTime[i];
+					Channel.Ticks[i] = Batch.FinalTicks[i];
+					Channel.Deaths[i] = Batch.Death[i];
+				}
+			}
+			Steps++;
+			Games += Ended;
+		}
+
+		Batch.GetObservations(Channel.Observations);
+		Channel.Respond(Ended);
+	}
+
+	if(!Quiet)
+		std::cout << "steps=" << Steps << " games=" << Games << std::endl;
+	return 0;
+}
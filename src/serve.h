@@ -0,0 +1,87 @@
+/******************************************************************************
+* openflap
+* Copyright (C) 2014  Alan Witkowski
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*******************************************************************************/
+#pragma once
+
+// Libraries
+#include <stdint.h>
+#include <stddef.h>
+#include <string>
+
+// Requests a client can make of the server
+enum ServeCommandType {
+	SERVE_STEP,
+	SERVE_RESET,
+	SERVE_QUIT,
+};
+
+struct _ServeHeader;
+
+// Batch of games in POSIX shared memory, stepped by a server process for a client on the same host.
+// Each side writes its half of the arrays and bumps a sequence number, and the other side spins
+// briefly then sleeps on it with a futex. The header holds both sides' process IDs, so a side
+// waiting on one that exited gives up and a new server only replaces memory left by a dead one.
+class _ServeChannel {
+
+	public:
+
+		_ServeChannel();
+		~_ServeChannel();
+
+		bool Create(const std::string &Name, int EnvCount);
+		bool Open(const std::string &Name);
+		void Close();
+
+		// Client
+		bool Call(ServeCommandType Command);
+
+		// Server
+		bool WaitRequest(ServeCommandType &Command);
+		void Respond(int Ended);
+
+		int GetEnvCount() const;
+		int GetEnded() const;
+
+		// Written by the client
+		uint32_t *Seeds;
+		uint8_t *Actions;
+
+		// Written by the server, with the results valid where Dones is set
+		float *Observations;
+		float *Rewards;
+		uint8_t *Dones;
+		float *Scores;
+		uint32_t *Ticks;
+		uint8_t *Deaths;
+
+	private:
+
+		_ServeChannel(const _ServeChannel &);
+		_ServeChannel &operator=(const _ServeChannel &);
+
+		bool Map(int File, size_t Size);
+		void SetArrays(const size_t *Offsets);
+
+		std::string Name;
+		_ServeHeader *Header;
+		size_t Size;
+		bool Owner;
+		bool Client;
+
+};
+
+int RunServe(const std::string &Name, int EnvCount, bool Quiet);
@@ -17,15 +17,47 @@
 *******************************************************************************/
 #include <sprite.h>
 
-void _Sprite::Update(float FrameTime) {
-	Physics.Update(FrameTime);
+// Add sprite to the back, returns false when full
+bool _SpriteBuffer::Add(float X, float Y, int Width, int Height, float Velocity, int Texture) {
+	if(Count == CAPACITY)
+		return false;
+
+	int Index = GetIndex(Count);
+	this->X[Index] = X;
+	this->LastX[Index] = X;
+	this->Y[Index] = Y;
+	this->Velocity[Index] = Velocity;
+	this->Width[Index] = Width;
+	this->Height[Index] = Height;
+	this->Texture[Index] = Texture;
+	Count++;
+
+	return true;
+}
+
+// Remove the oldest sprite
+void _SpriteBuffer::RemoveFront() {
+	if(!Count)
+		return;
+
+	Start = (Start + 1) & (CAPACITY - 1);
+	Count--;
 }
 
-void _Sprite::Render(SDL_Renderer *Renderer, float Blend) {
-	const Vector2 &Position = Physics.GetPosition();
-	const Vector2 &LastPosition = Physics.GetLastPosition();
-	Bounds.x = (int)(Position.X * Blend + LastPosition.X * (1.0f - Blend) + 0.5f);
-	Bounds.y = (int)(Position.Y * Blend + LastPosition.Y * (1.0f - Blend) + 0.5f);
+// Move sprites horizontally
+void _SpriteBuffer::Update(float FrameTime) {
+	for(int i = 0; i < Count; i++) {
+		int Index = GetIndex(i);
+		LastX[Index] = X[Index];
+		X[Index] += Velocity[Index] * FrameTime;
+	}
+}
 
-	SDL_RenderCopy(Renderer, Texture, nullptr, &Bounds);
+// Stop all sprites in place
+void _SpriteBuffer::Stop() {
+	for(int i = 0; i < Count; i++) {
+		int Index = GetIndex(i);
+		Velocity[Index] = 0.0f;
+		LastX[Index] = X[Index];
+	}
 }
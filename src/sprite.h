@@ -17,26 +17,38 @@
 *******************************************************************************/
 #pragma once
 
-// Libraries
-#include <SDL2/SDL.h>
-#include <vector2.h>
-#include <physics.h>
-
-// Sprite class
-class _Sprite {
+// Fixed capacity ring buffer of scrolling sprites stored as parallel arrays
+class _SpriteBuffer {
 
 	public:
 
-		_Sprite() : Texture(nullptr) { }
-		~_Sprite() { }
+		// Must be a power of two
+		static const int CAPACITY = 64;
+
+		_SpriteBuffer() : Start(0), Count(0) { }
+
+		void Clear() { Start = Count = 0; }
+		bool Add(float X, float Y, int Width, int Height, float Velocity, int Texture);
+		void RemoveFront();
 
 		void Update(float FrameTime);
-		void Render(SDL_Renderer *Renderer, float Blend);
+		void Stop();
 
-		float Radius;
-		_Physics Physics;
-		SDL_Rect Bounds;
-		SDL_Texture *Texture;
+		int GetCount() const { return Count; }
+		int GetIndex(int Position) const { return (Start + Position) & (CAPACITY - 1); }
 
-};
+		// Sprite data
+		float X[CAPACITY];
+		float LastX[CAPACITY];
+		float Y[CAPACITY];
+		float Velocity[CAPACITY];
+		int Width[CAPACITY];
+		int Height[CAPACITY];
+		int Texture[CAPACITY];
 
+	private:
+
+		int Start;
+		int Count;
+
+};
@@ -0,0 +1,101 @@
+/******************************************************************************
+* openflap
+* Copyright (C) 2014  Alan Witkowski
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*******************************************************************************/
+#include <textbuffer.h>
+
+// Append string, truncating when full
+_TextBuffer &_TextBuffer::Append(const char *Text) {
+	while(*Text)
+		AppendCharacter(*Text++);
+
+	return *this;
+}
+
+// Append unsigned integer
+_TextBuffer &_TextBuffer::Append(uint32_t Value) {
+	char Digits[10];
+	int Count = 0;
+	do {
+		Digits[Count++] = (char)('0' + Value % 10);
+		Value /= 10;
+	} while(Value);
+
+	while(Count)
+		AppendCharacter(Digits[--Count]);
+
+	return *this;
+}
+
+// Append number with a fixed number of decimal places
+_TextBuffer &_TextBuffer::Append(float Value, int Precision) {
+	if(Precision < 0)
+		Precision = 0;
+	if(Precision > 6)
+		Precision = 6;
+
+	double Number = Value;
+	if(Number < 0.0) {
+		AppendCharacter('-');
+		Number = -Number;
+	}
+
+	// Round to an integer count of the smallest decimal place, ties to even like printf
+	uint64_t Scale = 1;
+	for(int i = 0; i < Precision; i++)
+		Scale *= 10;
+
+	double Exact = Number * Scale;
+	uint64_t Scaled = (uint64_t)Exact;
+	double Remainder = Exact - (double)Scaled;
+	if(Remainder > 0.5 || (Remainder == 0.5 && (Scaled & 1)))
+		Scaled++;
+	uint64_t Whole = Scaled / Scale;
+	uint64_t Fraction = Scaled % Scale;
+
+	// Write whole part
+	char Digits[20];
+	int Count = 0;
+	do {
+		Digits[Count++] = (char)('0' + Whole % 10);
+		Whole /= 10;
+	} while(Whole);
+
+	while(Count)
+		AppendCharacter(Digits[--Count]);
+
+	// Write fraction with leading zeros
+	if(Precision) {
+		AppendCharacter('.');
+		for(int i = Precision - 1; i >= 0; i--) {
+			Digits[i] = (char)('0' + Fraction % 10);
+			Fraction /= 10;
+		}
+		for(int i = 0; i < Precision; i++)
+			AppendCharacter(Digits[i]);
+	}
+
+	return *this;
+}
+
+// Append single character, leaving room for the terminator
+void _TextBuffer::AppendCharacter(char Character) {
+	if(Length >= SIZE - 1)
+		return;
+
+	Data[Length++] = Character;
+	Data[Length] = '\0';
+}
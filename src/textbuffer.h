@@ -0,0 +1,47 @@
+/******************************************************************************
+* openflap
+* Copyright (C) 2014  Alan Witkowski
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*******************************************************************************/
+#pragma once
+
+// Libraries
+#include <stdint.h>
+
+// Builds short strings in a fixed size buffer without allocating
+class _TextBuffer {
+
+	public:
+
+		static const int SIZE = 64;
+
+		_TextBuffer() { Clear(); }
+
+		void Clear() { Length = 0; Data[0] = '\0'; }
+		_TextBuffer &Append(const char *Text);
+		_TextBuffer &Append(uint32_t Value);
+		_TextBuffer &Append(float Value, int Precision);
+
+		const char *GetText() const { return Data; }
+		int GetLength() const { return Length; }
+
+	private:
+
+		void AppendCharacter(char Character);
+
+		char Data[SIZE];
+		int Length;
+
+};
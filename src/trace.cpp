@@ -0,0 +1,142 @@
+/******************************************************************************
+* openflap
+* Copyright (C) 2014  Alan Witkowski
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*******************************************************************************/
+#include <trace.h>
+#include <iomanip>
+
+// How often the writer thread drains the ring
+const int TRACE_FLUSH_MILLISECONDS = 10;
+
+// Constructor
+_Trace::_Trace() :
+	Head(0),
+	Tail(0),
+	Running(false),
+	Dropped(0) {
+}
+
+// Destructor
+_Trace::~_Trace() {
+	Close();
+}
+
+// Open the output file and start the writer thread
+bool _Trace::Open(const std::string &Path) {
+	File.open(Path.c_str());
+	if(!File)
+		return false;
+
+	Events.resize(CAPACITY);
+	Head = Tail = 0;
+	Dropped = 0;
+	StartTime = std::chrono::steady_clock::now();
+
+	File << std::fixed << std::setprecision(3);
+	File << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+	File << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":1,\"args\":{\"name\":\"main\"}}";
+
+	Running = true;
+	Thread = std::thread([this]() {
+		while(Running) {
+			Flush();
+			std::this_thread::sleep_for(std::chrono::milliseconds(TRACE_FLUSH_MILLISECONDS));
+		}
+	});
+
+	return true;
+}
+
+// Stop the writer thread and finish the file
+void _Trace::Close() {
+	if(!Running)
+		return;
+
+	Running = false;
+	Thread.join();
+	Flush();
+
+	File << "\n]}\n";
+	File.close();
+}
+
+// Get nanoseconds since the trace was opened
+uint64_t _Trace::GetTime() const {
+	return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - StartTime).count();
+}
+
+// Add a span that started at StartTime and ends now
+void _Trace::Complete(const char *Name, uint64_t StartTime, const char *ArgumentName, double Argument) {
+	if(!Running)
+		return;
+
+	uint64_t Time = GetTime();
+	_Event Event = { Name, ArgumentName, StartTime, Time - StartTime, Argument, 'X' };
+	Add(Event);
+}
+
+// Add a counter sample
+void _Trace::Counter(const char *Name, double Value) {
+	if(!Running)
+		return;
+
+	_Event Event = { Name, Name, GetTime(), 0, Value, 'C' };
+	Add(Event);
+}
+
+// Add a marker
+void _Trace::Instant(const char *Name) {
+	if(!Running)
+		return;
+
+	_Event Event = { Name, nullptr, GetTime(), 0, 0.0, 'i' };
+	Add(Event);
+}
+
+// Copy an event into the ring, dropping it if the writer has fallen behind
+void _Trace::Add(const _Event &Event) {
+	uint32_t Position = Head.load(std::memory_order_relaxed);
+	if(Position - Tail.load(std::memory_order_acquire) >= CAPACITY) {
+		Dropped++;
+		return;
+	}
+
+	Events[Position & (CAPACITY - 1)] = Event;
+	Head.store(Position + 1, std::memory_order_release);
+}
+
+// Write out every event added so far
+void _Trace::Flush() {
+	uint32_t Position = Tail.load(std::memory_order_relaxed);
+	uint32_t End = Head.load(std::memory_order_acquire);
+	for(; Position != End; Position++)
+		Write(Events[Position & (CAPACITY - 1)]);
+
+	Tail.store(Position, std::memory_order_release);
+	File.flush();
+}
+
+// Write one event in trace event format with microsecond timestamps
+void _Trace::Write(const _Event &Event) {
+	File << ",\n{\"name\":\"" << Event.Name << "\",\"ph\":\"" << Event.Type << "\",\"pid\":1,\"tid\":1,\"ts\":" << Event.StartTime / 1000.0;
+	if(Event.Type == 'X')
+		File << ",\"dur\":" << Event.Duration / 1000.0;
+	else if(Event.Type == 'i')
+		File << ",\"s\":\"t\"";
+	if(Event.ArgumentName)
+		File << ",\"args\":{\"" << Event.ArgumentName << "\":" << Event.Argument << "}";
+	File << "}";
+}
@@ -0,0 +1,77 @@
+/******************************************************************************
+* openflap
+* Copyright (C) 2014  Alan Witkowski
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*******************************************************************************/
+#pragma once
+
+// Libraries
+#include <stdint.h>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Writes Chrome trace event JSON, buffering events in a ring that a background thread drains
+class _Trace {
+
+	public:
+
+		// Must be a power of two
+		static const uint32_t CAPACITY = 1 << 16;
+
+		_Trace();
+		~_Trace();
+
+		bool Open(const std::string &Path);
+		void Close();
+
+		bool IsOpen() const { return Running; }
+		uint64_t GetTime() const;
+
+		void Complete(const char *Name, uint64_t StartTime, const char *ArgumentName = nullptr, double Argument = 0.0);
+		void Counter(const char *Name, double Value);
+		void Instant(const char *Name);
+
+		uint64_t GetDropped() const { return Dropped; }
+
+	private:
+
+		// One buffered event, names must be string literals
+		struct _Event {
+			const char *Name;
+			const char *ArgumentName;
+			uint64_t StartTime;
+			uint64_t Duration;
+			double Argument;
+			char Type;
+		};
+
+		void Add(const _Event &Event);
+		void Flush();
+		void Write(const _Event &Event);
+
+		std::ofstream File;
+		std::thread Thread;
+		std::vector<_Event> Events;
+		std::atomic<uint32_t> Head;
+		std::atomic<uint32_t> Tail;
+		std::atomic<bool> Running;
+		std::chrono::steady_clock::time_point StartTime;
+		uint64_t Dropped;
+
+};
@@ -47,8 +47,6 @@ union Vector2 {
 		Vector2 CrossProduct(const Vector2 &Vector) const;
 
 		// Operators
-		Vector2(const Vector2 &Vector);
-		Vector2 &operator=(const Vector2 &Vector);
 		bool operator==(const Vector2 &Vector) const;
 		bool operator!=(const Vector2 &Vector) const;
 		Vector2 operator+(const Vector2 &Vector) const;
@@ -139,20 +137,6 @@ inline Vector2 Vector2::RotateVector(float Degrees) const {
 	return Vector2(Cosine * X - Sine * Y, Sine * X + Cosine * Y);
 }
 
-// Copy constructor
-inline Vector2::Vector2(const Vector2 &Vector) {
-	X = Vector.X;
-	Y = Vector.Y;
-}
-
-// Assignment
-inline Vector2 &Vector2::operator=(const Vector2 &Vector) {
-	X = Vector.X;
-	Y = Vector.Y;
-
-	return *this;
-}
-
 // Equality
 inline bool Vector2::operator==(const Vector2 &Vector) const {
 
@@ -0,0 +1,125 @@
+/******************************************************************************
+* openflap
+* Copyright (C) 2014  Alan Witkowski
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*******************************************************************************/
+#include <workpool.h>
+#include <thread>
+
+// Constructor
+_WorkPool::_WorkPool(int ThreadCount) :
+	ThreadCount(ThreadCount < 1 ? 1 : ThreadCount),
+	Queues(this->ThreadCount) {
+}
+
+// Get the number of hardware threads
+int _WorkPool::GetDefaultThreadCount() {
+	int Count = (int)std::thread::hardware_concurrency();
+	return Count > 0 ? Count : 1;
+}
+
+// Process indices [Begin, End) in chunks, blocking until all are done
+void _WorkPool::Run(uint64_t Begin, uint64_t End, uint64_t ChunkSize, const TaskType &Task) {
+	if(ChunkSize < 1)
+		ChunkSize = 1;
+
+	// Give each worker an equal share
+	uint64_t Count = End > Begin ? End - Begin : 0;
+	for(int i = 0; i < ThreadCount; i++) {
+		Queues[i].Begin = Begin + Count * i / ThreadCount;
+		Queues[i].End = Begin + Count * (i + 1) / ThreadCount;
+	}
+
+	if(ThreadCount == 1) {
+		Work(0, ChunkSize, Task);
+		return;
+	}
+
+	std::vector<std::thread> Threads;
+	for(int i = 0; i < ThreadCount; i++)
+		Threads.push_back(std::thread(&_WorkPool::Work, this, i, ChunkSize, std::cref(Task)));
+
+	for(size_t i = 0; i < Threads.size(); i++)
+		Threads[i].join();
+}
+
+// Worker loop
+void _WorkPool::Work(int Worker, uint64_t ChunkSize, const TaskType &Task) {
+	uint64_t Begin, End;
+	for(;;) {
+		while(Take(Worker, ChunkSize, Begin, End))
+			Task(Worker, Begin, End);
+
+		if(!Steal(Worker))
+			break;
+	}
+}
+
+// Take a chunk from the front of a worker's own range
+bool _WorkPool::Take(int Worker, uint64_t ChunkSize, uint64_t &Begin, uint64_t &End) {
+	_Queue &Queue = Queues[Worker];
+	std::lock_guard<std::mutex> Lock(Queue.Mutex);
+	if(Queue.Begin >= Queue.End)
+		return false;
+
+	Begin = Queue.Begin;
+	End = Queue.End - Queue.Begin > ChunkSize ? Queue.Begin + ChunkSize : Queue.End;
+	Queue.Begin = End;
+
+	return true;
+}
+
+// Move the back half of the busiest worker's range into an empty queue
+bool _WorkPool::Steal(int Worker) {
+	for(;;) {
+
+		// Find victim with the most remaining work
+		int Victim = -1;
+		uint64_t Largest = 0;
+		for(int i = 0; i < ThreadCount; i++) {
+			if(i == Worker)
+				continue;
+
+			std::lock_guard<std::mutex> Lock(Queues[i].Mutex);
+			uint64_t Remaining = Queues[i].End - Queues[i].Begin;
+			if(Queues[i].Begin < Queues[i].End && Remaining > Largest) {
+				Largest = Remaining;
+				Victim = i;
+			}
+		}
+
+		if(Victim == -1)
+			return false;
+
+		// Split victim's range, taking the back half
+		uint64_t Begin, End;
+		{
+			std::lock_guard<std::mutex> Lock(Queues[Victim].Mutex);
+			_Queue &Queue = Queues[Victim];
+			if(Queue.Begin >= Queue.End)
+				continue;
+
+			End = Queue.End;
+			Begin = Queue.Begin + (Queue.End - Queue.Begin) / 2;
+			Queue.End = Begin;
+		}
+
+		std::lock_guard<std::mutex> Lock(Queues[Worker].Mutex);
+		Queues[Worker].Begin = Begin;
+		Queues[Worker].End = End;
+
+		return true;
+	}
+}
@@ -0,0 +1,56 @@
+/******************************************************************************
+* openflap
+* Copyright (C) 2014  Alan Witkowski
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*******************************************************************************/
+#pragma once
+
+// Libraries
+#include <stdint.h>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+// Splits an index range across threads, letting idle threads steal work
+class _WorkPool {
+
+	public:
+
+		typedef std::function<void(int Worker, uint64_t Begin, uint64_t End)> TaskType;
+
+		_WorkPool(int ThreadCount);
+
+		void Run(uint64_t Begin, uint64_t End, uint64_t ChunkSize, const TaskType &Task);
+
+		int GetThreadCount() const { return ThreadCount; }
+
+		static int GetDefaultThreadCount();
+
+	private:
+
+		// Remaining range owned by a worker
+		struct _Queue {
+			std::mutex Mutex;
+			uint64_t Begin, End;
+		};
+
+		void Work(int Worker, uint64_t ChunkSize, const TaskType &Task);
+		bool Take(int Worker, uint64_t ChunkSize, uint64_t &Begin, uint64_t &End);
+		bool Steal(int Worker);
+
+		int ThreadCount;
+		std::vector<_Queue> Queues;
+
+};
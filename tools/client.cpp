@@ -0,0 +1,96 @@
+/******************************************************************************
+* openflap
+* Copyright (C) 2014  Alan Witkowski
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*******************************************************************************/
+#include <serve.h>
+#include <batch.h>
+#include <constants.h>
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <algorithm>
+#include <vector>
+#include <string>
+#include <cstdlib>
+
+// Drive a server's games with the follow rule and report round trip times
+int main(int ArgumentCount, char **Arguments) {
+	if(ArgumentCount < 2) {
+		std::cout << "Usage: openflap_client name [steps] [--quit]" << std::endl;
+		return 1;
+	}
+
+	int StepCount = ArgumentCount > 2 ? atoi(Arguments[2]) : 10000;
+	bool Quit = ArgumentCount > 3 && std::string(Arguments[3]) == "--quit";
+
+	_ServeChannel Channel;
+	if(!Channel.Open(Arguments[1])) {
+		std::cout << "Cannot open shared memory: " << Arguments[1] << std::endl;
+		return 1;
+	}
+
+	int EnvCount = Channel.GetEnvCount();
+	for(int i = 0; i < EnvCount; i++)
+		Channel.Seeds[i] = i;
+	if(!Channel.Call(SERVE_RESET)) {
+		std::cout << "Server exited" << std::endl;
+		return 1;
+	}
+
+	std::vector<double> RoundTrips;
+	RoundTrips.reserve(StepCount);
+	uint64_t Games = 0;
+	double TotalScore = 0.0;
+	std::chrono::steady_clock::time_point StartTime = std::chrono::steady_clock::now();
+	for(int Step = 0; Step < StepCount; Step++) {
+		for(int i = 0; i < EnvCount; i++) {
+			const float *Observation = &Channel.Observations[i * _Batch::OBSERVATION_SIZE];
+			float Bottom = Observation[3] + SPACING - PLAYER_RADIUS;
+			float NextY = Observation[0] + (Observation[1] + GRAVITY * GAME_TIMESTEP) * GAME_TIMESTEP;
+			Channel.Actions[i] = Observation[1] > 0.0f && NextY >= Bottom;
+		}
+
+		std::chrono::steady_clock::time_point CallTime = std::chrono::steady_clock::now();
+		if(!Channel.Call(SERVE_STEP)) {
+			std::cout << "Server exited" << std::endl;
+			return 1;
+		}
+		RoundTrips.push_back(std::chrono::duration<double>(std::chrono::steady_clock::now() - CallTime).count());
+
+		if(Channel.GetEnded()) {
+			for(int i = 0; i < EnvCount; i++) {
+				if(Channel.Dones[i]) {
+					TotalScore += Channel.Scores[i];
+					Games++;
+				}
+			}
+		}
+	}
+	double Elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - StartTime).count();
+
+	if(Quit)
+		Channel.Call(SERVE_QUIT);
+
+	std::sort(RoundTrips.begin(), RoundTrips.end());
+	double Median = RoundTrips.size() ? RoundTrips[RoundTrips.size() / 2] : 0.0;
+	double Tail = RoundTrips.size() ? RoundTrips[RoundTrips.size() * 99 / 100] : 0.0;
+	std::cout << "envs=" << EnvCount << " steps=" << StepCount << " games=" << Games;
+	std::cout << std::fixed << std::setprecision(2) << " average=" << (Games ? TotalScore / Games : 0.0);
+	std::cout << std::setprecision(1) << " round_trip_p50_us=" << Median * 1e6 << " round_trip_p99_us=" << Tail * 1e6;
+	std::cout << std::setprecision(0) << " env_steps/sec=" << (double)EnvCount * StepCount / Elapsed << std::endl;
+
+	return 0;
+}
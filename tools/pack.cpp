@@ -0,0 +1,44 @@
+/******************************************************************************
+* openflap
+* Copyright (C) 2014  Alan Witkowski
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*******************************************************************************/
+#include <pack.h>
+#include <iostream>
+
+// Build an asset pack from files in a data directory
+int main(int ArgumentCount, char **Arguments) {
+	if(ArgumentCount < 4) {
+		std::cout << "Usage: openflap_pack output.pak directory/ file..." << std::endl;
+		return 1;
+	}
+
+	std::vector<std::string> Names(Arguments + 3, Arguments + ArgumentCount);
+	if(!_Pack::Build(Arguments[1], Arguments[2], Names)) {
+		std::cout << "Cannot build pack: " << Arguments[1] << std::endl;
+		return 1;
+	}
+
+	// Check the result can be read back
+	_Pack Pack;
+	if(!Pack.Open(Arguments[1])) {
+		std::cout << "Cannot read pack: " << Arguments[1] << std::endl;
+		return 1;
+	}
+
+	std::cout << "Packed " << Names.size() << " files into " << Arguments[1] << std::endl;
+
+	return 0;
+}